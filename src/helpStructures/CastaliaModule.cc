@@ -11,40 +11,34 @@
  ****************************************************************************/
 
 #include "CastaliaModule.h"
+#include "ResourceManager.h"
+#include "ResultWriter.h"
 
 #define CASTALIA_PREFIX "Castalia|\t"
 
 void CastaliaModule::finish()
 {
 	finishSpecific();
-	if (simpleoutputs.size() == 0 && histograms.size() == 0)
+	if (simpleoutputs.size() == 0 && histograms.size() == 0 && timeSeries.size() == 0)
 		return;
+	if (ResultWriter::isEnabled()) {
+		writeResults();
+		return;
+	}
 	bool header = true;
 
-	simpleOutputMapType::iterator i1;
-	for (i1 = simpleoutputs.begin(); i1 != simpleoutputs.end(); i1++) {
+	// outputs are printed sorted by name, and their labels sorted as well
+	map<string,int>::iterator i1;
+	for (i1 = simpleOutputHandles.begin(); i1 != simpleOutputHandles.end(); i1++) {
 		string descr = i1->first;
-		simpleOutputByIndex *outByIndex = &i1->second;
-		map<int,simpleOutputTypeDef>::iterator i2;
-		for (i2 = outByIndex->byIndex.begin(); i2 != outByIndex->byIndex.end(); i2++) {
-			int index = i2->first;
-			simpleOutputTypeDef *out = &i2->second;
-			if (out->data.size() == 0)
-				continue;
-			if (header) {
-				EV << CASTALIA_PREFIX << "module:" << getFullPath() << endl;
-				header = false;
-			}
-			EV << CASTALIA_PREFIX << "\t";
-			if (index >= 0)
-				EV << " index:" << index << " ";
-			EV << "simple output name:" << descr << endl;
-			map<string,double>::iterator i3;
-			for (i3 = out->data.begin(); i3 != out->data.end(); i3++)
-				EV << CASTALIA_PREFIX "\t\t" << i3->second << " " << i3->first << endl;
-		}
+		simpleOutputByIndex *outByIndex = &simpleoutputs[i1->second];
+		printSimpleOutput(descr, outByIndex, -1, &outByIndex->noIndex, header);
+		map <int,simpleOutputTypeDef>::iterator i2;
+		for (i2 = outByIndex->byIndex.begin(); i2 != outByIndex->byIndex.end(); i2++)
+			printSimpleOutput(descr, outByIndex, i2->first, &i2->second, header);
 	}
 	simpleoutputs.clear();
+	simpleOutputHandles.clear();
 
 	histogramOutputMapType::iterator i4;
 	for (i4 = histograms.begin(); i4 != histograms.end(); i4++) {
@@ -73,26 +67,218 @@ void CastaliaModule::finish()
 		}
 	}
 	histograms.clear();
+
+	map<string,int>::iterator i6;
+	for (i6 = timeSeriesHandles.begin(); i6 != timeSeriesHandles.end(); i6++) {
+		timeSeriesOutputByIndex *series = &timeSeries[i6->second];
+		int numBins = timeSeriesLength(series);
+		map <int, vector <double> >::iterator i7;
+		for (i7 = series->byIndex.begin(); i7 != series->byIndex.end(); i7++) {
+			int index = i7->first;
+			if (header) {
+				EV << CASTALIA_PREFIX << "module:" << getFullPath() << endl;
+				header = false;
+			}
+			EV << CASTALIA_PREFIX << "\t";
+			if (index >= 0)
+				EV << " index:" << index << " ";
+			EV << "time series name:" << i6->first << endl;
+			EV << CASTALIA_PREFIX << "\ttime_series_window:" << series->window << endl;
+			EV << CASTALIA_PREFIX << "\ttime_series_values";
+			for (int i = 0; i < numBins; i++)
+				EV << " " << (i < (int)i7->second.size() ? i7->second[i] : 0.0);
+			EV << endl;
+		}
+	}
+	timeSeries.clear();
+	timeSeriesHandles.clear();
+}
+
+/* Number of bins that cover the simulation so far, and all collected values
+ */
+int CastaliaModule::timeSeriesLength(timeSeriesOutputByIndex *series)
+{
+	int numBins = (int)ceil(SIMTIME_DBL(simTime()) / series->window);
+	map <int, vector <double> >::iterator i;
+	for (i = series->byIndex.begin(); i != series->byIndex.end(); i++) {
+		int last = i->second.size() - 1;
+		while (last >= numBins && i->second[last] == 0)
+			last--;
+		if (last + 1 > numBins)
+			numBins = last + 1;
+	}
+	return numBins > 0 ? numBins : 1;
+}
+
+// prints one simple output with one index, preceded by the module header once
+void CastaliaModule::printSimpleOutput(const string & descr, simpleOutputByIndex *outByIndex,
+		int index, simpleOutputTypeDef *out, bool & header)
+{
+	if (out->numCollected == 0)
+		return;
+	if (header) {
+		EV << CASTALIA_PREFIX << "module:" << getFullPath() << endl;
+		header = false;
+	}
+	EV << CASTALIA_PREFIX << "\t";
+	if (index >= 0)
+		EV << " index:" << index << " ";
+	EV << "simple output name:" << descr << endl;
+	map<string,int>::iterator i3;
+	for (i3 = outByIndex->labelIds.begin(); i3 != outByIndex->labelIds.end(); i3++) {
+		int label = i3->second;
+		if (label < (int)out->collected.size() && out->collected[label])
+			EV << CASTALIA_PREFIX "\t\t" << out->data[label] << " " << i3->first << endl;
+	}
+}
+
+/* Writes one simple output with one index to the result file. The output
+ * name and labels are interned the first time they are written
+ */
+void CastaliaModule::writeSimpleOutput(int module, const string & descr,
+		simpleOutputByIndex *outByIndex, int index, simpleOutputTypeDef *out,
+		int & name, vector <int> & labels)
+{
+	if (out->numCollected == 0)
+		return;
+	if (name < 0)
+		name = ResultWriter::internString(descr);
+	for (int label = 0; label < (int)out->collected.size(); label++) {
+		if (!out->collected[label])
+			continue;
+		if (labels[label] < 0)
+			labels[label] = ResultWriter::internString(outByIndex->labels[label]);
+		ResultWriter::writeOutput(module, name, index, labels[label], out->data[label]);
+	}
+}
+
+/* Writes the same outputs that finish() prints to the structured result
+ * file, without formatting any text
+ */
+void CastaliaModule::writeResults()
+{
+	int module = ResultWriter::internString(getFullPath());
+
+	map<string,int>::iterator i1;
+	for (i1 = simpleOutputHandles.begin(); i1 != simpleOutputHandles.end(); i1++) {
+		simpleOutputByIndex *outByIndex = &simpleoutputs[i1->second];
+		int name = -1;
+		vector <int> labels(outByIndex->labels.size(), -1);
+		writeSimpleOutput(module, i1->first, outByIndex, -1, &outByIndex->noIndex, name, labels);
+		map <int,simpleOutputTypeDef>::iterator i2;
+		for (i2 = outByIndex->byIndex.begin(); i2 != outByIndex->byIndex.end(); i2++)
+			writeSimpleOutput(module, i1->first, outByIndex, i2->first, &i2->second, name, labels);
+	}
+	simpleoutputs.clear();
+	simpleOutputHandles.clear();
+
+	histogramOutputMapType::iterator i3;
+	for (i3 = histograms.begin(); i3 != histograms.end(); i3++) {
+		histogramOutputByIndex *hist = &i3->second;
+		if (!hist->active || hist->byIndex.empty())
+			continue;
+		int name = ResultWriter::internString(i3->first);
+		map <int,histogramOutputTypeDef>::iterator i4;
+		for (i4 = hist->byIndex.begin(); i4 != hist->byIndex.end(); i4++)
+			ResultWriter::writeHistogram(module, name, i4->first,
+				hist->min, hist->max, i4->second.buckets);
+	}
+	histograms.clear();
+
+	map<string,int>::iterator i5;
+	for (i5 = timeSeriesHandles.begin(); i5 != timeSeriesHandles.end(); i5++) {
+		timeSeriesOutputByIndex *series = &timeSeries[i5->second];
+		if (series->byIndex.empty())
+			continue;
+		int name = ResultWriter::internString(i5->first);
+		int numBins = timeSeriesLength(series);
+		map <int, vector <double> >::iterator i6;
+		for (i6 = series->byIndex.begin(); i6 != series->byIndex.end(); i6++) {
+			i6->second.resize(numBins, 0.0);
+			ResultWriter::writeTimeSeries(module, name, i6->first, series->window, i6->second);
+		}
+	}
+	timeSeries.clear();
+	timeSeriesHandles.clear();
 }
 
 std::ostream & CastaliaModule::trace()
 {
-	if (hasPar("collectTraceInfo") && par("collectTraceInfo")) {
-		return (ostream &) DebugInfoWriter::getStream() <<
-			"\n" << setw(18) << simTime() << setw(40) << getFullPath() << " ";
+	if (isTraceEnabled()) {
+		if (tracePathId < 0)
+			tracePathId = DebugInfoWriter::internString(getFullPath());
+		return DebugInfoWriter::getStream(simTime(), getId(), tracePathId);
 	} else {
 		return empty;
 	}
 }
 
+/* collectTraceInfo is read once and cached. If it is changed at runtime,
+ * it is read again on the next trace
+ */
+void CastaliaModule::handleParameterChange(const char *parName)
+{
+	if (parName == NULL || strcmp(parName, "collectTraceInfo") == 0)
+		traceEnabled = -1;
+}
+
 std::ostream & CastaliaModule::debug()
 {
 	return cerr;
 }
 
-void CastaliaModule::declareOutput(const char *descr)
+/* Declare an output and return its handle. Declaring an output again
+ * clears what was collected, but keeps its handle and label ids
+ */
+int CastaliaModule::declareOutput(const char *descr)
+{
+	map<string,int>::iterator i = simpleOutputHandles.find(descr);
+	if (i != simpleOutputHandles.end()) {
+		simpleoutputs[i->second].clear();
+		return i->second;
+	}
+	int handle = simpleoutputs.size();
+	simpleoutputs.push_back(simpleOutputByIndex());
+	simpleOutputHandles[descr] = handle;
+	return handle;
+}
+
+/* Register a label of an output and return its id. Registering a
+ * label again returns the same id
+ */
+int CastaliaModule::declareOutputLabel(int handle, const char *label)
 {
-	simpleoutputs[descr].byIndex.clear();
+	if (handle < 0 || handle >= (int)simpleoutputs.size())
+		opp_error("declareOutputLabel: output handle %i not declared", handle);
+	simpleOutputByIndex &out = simpleoutputs[handle];
+	map<string,int>::iterator i = out.labelIds.find(label);
+	if (i != out.labelIds.end())
+		return i->second;
+	int labelId = out.labels.size();
+	out.labels.push_back(label);
+	out.labelIds[label] = labelId;
+	return labelId;
+}
+
+void CastaliaModule::collectOutput(int handle, int index, int labelId, double amt)
+{
+	if (index < -1)
+		opp_error("Negative output index not permitted");
+	if (handle < 0 || handle >= (int)simpleoutputs.size())
+		return;
+	simpleOutputByIndex &out = simpleoutputs[handle];
+	if (labelId < 0 || labelId >= (int)out.labels.size())
+		opp_error("collectOutput: label id %i not declared for output %i", labelId, handle);
+	simpleOutputTypeDef &values = *out.getValues(index);
+	if (labelId >= (int)values.data.size()) {
+		values.data.resize(out.labels.size(), 0.0);
+		values.collected.resize(out.labels.size(), false);
+	}
+	if (!values.collected[labelId]) {
+		values.collected[labelId] = true;
+		values.numCollected++;
+	}
+	values.data[labelId] += amt;
 }
 
 void CastaliaModule::collectOutput(const char *descr, int index)
@@ -113,10 +299,10 @@ void CastaliaModule::collectOutput(const char *descr, int index,
 void CastaliaModule::collectOutputNocheck(const char *descr, int index,
 						const char *label, double amt)
 {
-	simpleOutputMapType::iterator i = simpleoutputs.find(descr);
-	if (i == simpleoutputs.end())
+	map<string,int>::iterator i = simpleOutputHandles.find(descr);
+	if (i == simpleOutputHandles.end())
 		return;
-	i->second.byIndex[index].data[label] += amt;
+	collectOutput(i->second, index, declareOutputLabel(i->second, label), amt);
 }
 
 void CastaliaModule::collectOutput(const char *descr, int index, const char *label)
@@ -172,22 +358,98 @@ void CastaliaModule::collectHistogramNocheck(const char *descr, int index, doubl
 	i1->second.active = true;
 }
 
+/* Declare a time series and return its handle. Declaring it again clears
+ * what was collected and sets the new window
+ */
+int CastaliaModule::declareTimeSeries(const char *descr, double window)
+{
+	if (window <= 0)
+		opp_error("ERROR: declareTimeSeries failed, bad parameters");
+
+	int handle;
+	map<string,int>::iterator i = timeSeriesHandles.find(descr);
+	if (i != timeSeriesHandles.end()) {
+		handle = i->second;
+	} else {
+		handle = timeSeries.size();
+		timeSeries.push_back(timeSeriesOutputByIndex());
+		timeSeriesHandles[descr] = handle;
+	}
+	timeSeriesOutputByIndex &series = timeSeries[handle];
+	series.window = window;
+	series.byIndex.clear();
+
+	const char *limit = ev.getConfig()->getConfigValue("sim-time-limit");
+	double duration = limit ? cConfiguration::parseDouble(limit, "s", 0) : 0;
+	double bins = duration > 0 ? ceil(duration / window) : 1;
+	series.numBins = bins < TIME_SERIES_MAX_INITIAL_BINS ? (int)bins : TIME_SERIES_MAX_INITIAL_BINS;
+	return handle;
+}
+
+void CastaliaModule::collectTimeSeries(int handle, int index, double value)
+{
+	if (index < -1)
+		opp_error("Negative output index not permitted");
+	if (handle < 0 || handle >= (int)timeSeries.size())
+		return;
+	timeSeriesOutputByIndex &series = timeSeries[handle];
+	int bin = (int)floor(SIMTIME_DBL(simTime()) / series.window);
+	vector <double> &bins = series.byIndex[index];
+	if (bin >= (int)bins.size()) {
+		int size = bins.empty() ? series.numBins : 2 * bins.size();
+		bins.resize(size > bin ? size : bin + 1, 0.0);
+	}
+	bins[bin] += value;
+}
+
+void CastaliaModule::collectTimeSeries(const char *descr, int index, double value)
+{
+	if (index < 0)
+		opp_error("Negative output index not permitted");
+	collectTimeSeriesNocheck(descr, index, value);
+}
+
+void CastaliaModule::collectTimeSeriesNocheck(const char *descr, int index, double value)
+{
+	map<string,int>::iterator i = timeSeriesHandles.find(descr);
+	if (i == timeSeriesHandles.end())
+		return;
+	collectTimeSeries(i->second, index, value);
+}
+
+/* A signature of the module type and the values of the given parameters
+ * (a NULL terminated list of the parameters the module parses), to intern
+ * what the module derives from them (see SharedParameters). It is empty if
+ * one of them is volatile, since such a module can not share them.
+ */
+string CastaliaModule::parameterSignature(const char **names)
+{
+	string signature(getNedTypeName());
+	for (int i = 0; names[i] != NULL; i++) {
+		cPar &p = par(names[i]);
+		if (p.isVolatile())
+			return string();
+		signature += '\n';
+		signature += p.str();
+	}
+	return signature;
+}
+
 void CastaliaModule::powerDrawn(double power)
 {
     if (!classPointers.resourceManager) {
 		string name(getName());
 		if (name.compare("Radio") == 0) 
-			classPointers.resourceManager = getParentModule()->getParentModule()->getSubmodule("ResourceManager");
+			classPointers.resourceManager = dynamic_cast<ResourceManager*>
+				(getParentModule()->getParentModule()->getSubmodule("ResourceManager"));
 		else if (name.compare("SensorManager") == 0)
-			classPointers.resourceManager = getParentModule()->getSubmodule("ResourceManager");
+			classPointers.resourceManager = dynamic_cast<ResourceManager*>
+				(getParentModule()->getSubmodule("ResourceManager"));
 		else
 			opp_error("%s module has no rights to call drawPower() function", getFullPath().c_str());
         if (!classPointers.resourceManager) 
         	opp_error("Unable to find pointer to resource manager module");
     }
 
-	ResourceManagerMessage *drawPowerMsg =
-	    new ResourceManagerMessage("Power consumption message", RESOURCE_MANAGER_DRAW_POWER);
-	drawPowerMsg->setPowerConsumed(power);
-	sendDirect(drawPowerMsg, classPointers.resourceManager, "powerConsumption");
+	classPointers.resourceManager->drawPower(getId(), power);
 }
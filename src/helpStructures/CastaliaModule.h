@@ -18,6 +18,7 @@
 #include <omnetpp.h>
 #include <iostream>
 #include <iomanip>
+#include <sstream>
 
 #include "DebugInfoWriter.h"
 #include "CastaliaMessages.h"
@@ -25,6 +26,8 @@
 
 using namespace std;
 
+class ResourceManager;
+
 struct nullstream:ostream {
 	struct nullbuf:streambuf {
 		int overflow(int c) {
@@ -36,7 +39,11 @@ struct nullstream:ostream {
 };
 
 struct simpleOutputTypeDef {
-	map <string,double> data;
+	vector <double> data;		// by label id
+	vector <bool> collected;	// labels collected at least once
+	int numCollected;
+
+	simpleOutputTypeDef():numCollected(0) { }
 };
 
 struct histogramOutputTypeDef {
@@ -44,7 +51,18 @@ struct histogramOutputTypeDef {
 };
 
 struct simpleOutputByIndex {
-	map <int, simpleOutputTypeDef> byIndex;
+	vector <string> labels;		// by label id
+	map <string, int> labelIds;
+	simpleOutputTypeDef noIndex;	// kept apart, it is collected most often
+	map <int, simpleOutputTypeDef> byIndex;	// sparse, indices are often node ids
+
+	simpleOutputTypeDef *getValues(int index) {
+		return index < 0 ? &noIndex : &byIndex[index];
+	}
+	void clear() {
+		noIndex = simpleOutputTypeDef();
+		byIndex.clear();
+	}
 };
 
 struct histogramOutputByIndex {
@@ -56,35 +74,114 @@ struct histogramOutputByIndex {
 	map <int, histogramOutputTypeDef> byIndex;
 };
 
+// most bins allocated up front for one index, more are added as values come
+#define TIME_SERIES_MAX_INITIAL_BINS 4096
+
+/* Values summed in bins of simulation time. Bins for the whole simulation
+ * (sim-time-limit, up to TIME_SERIES_MAX_INITIAL_BINS) are allocated when an
+ * index is first collected, they grow as needed beyond that
+ */
+struct timeSeriesOutputByIndex {
+	double window;		// width of a bin, in seconds
+	int numBins;
+	map <int, vector <double> > byIndex;
+};
+
 struct classPointersType {
-	cModule *resourceManager;
+	ResourceManager *resourceManager;
 
 	/* initialize the struct (C++ syntax) */
 	classPointersType():resourceManager(NULL) { }
 };
 
-typedef map <string, simpleOutputByIndex> simpleOutputMapType;
+/* Interned module parameters. Modules with identical parsed parameters (the
+ * same CastaliaModule::parameterSignature) share one immutable object of type T,
+ * holding whatever they derive from their parameters, instead of each module
+ * deriving and keeping its own copy. Objects are kept as long as the process,
+ * so consecutive runs with the same configuration reuse them as well.
+ */
+template <class T> class SharedParameters {
+ private:
+	static map<string, T*> &interned() {
+		static map<string, T*> parameters;
+		return parameters;
+	}
+	static vector<T*> &unshared() {
+		static vector<T*> parameters;
+		return parameters;
+	}
+
+ public:
+	// parameters already interned under the signature, NULL if there are none
+	static const T *find(const string &signature) {
+		if (signature.empty())
+			return NULL;
+		typename map<string, T*>::iterator it = interned().find(signature);
+		return it == interned().end() ? NULL : it->second;
+	}
+
+	// intern new parameters. With an empty signature they are not shared
+	static const T *intern(const string &signature, T *parameters) {
+		if (signature.empty())
+			unshared().push_back(parameters);
+		else
+			interned()[signature] = parameters;
+		return parameters;
+	}
+};
+
 typedef map <string, histogramOutputByIndex> histogramOutputMapType;
 
+/* Trace output that costs nothing when tracing is disabled: the stream
+ * expression after it is not evaluated at all. Use as TRACE << a << b;
+ */
+#define TRACE if (!isTraceEnabled()) ; else trace()
+
 class CastaliaModule: public virtual cSimpleModule {
  private:
-	simpleOutputMapType simpleoutputs;
+	vector <simpleOutputByIndex> simpleoutputs;	// by output handle
+	map <string, int> simpleOutputHandles;
 	histogramOutputMapType histograms;
+	vector <timeSeriesOutputByIndex> timeSeries;	// by time series handle
+	map <string, int> timeSeriesHandles;
 
 	classPointersType classPointers;
 
+	int traceEnabled;	// cached collectTraceInfo, -1 if not read yet
+	int tracePathId;	// full path interned by DebugInfoWriter, -1 if not yet
+
 	void collectOutputNocheck(const char *, int, const char *, double);
 	void collectHistogramNocheck(const char *, int, double);
+	void collectTimeSeriesNocheck(const char *, int, double);
+	void writeResults();
+	void printSimpleOutput(const string &, simpleOutputByIndex *, int,
+			simpleOutputTypeDef *, bool &);
+	void writeSimpleOutput(int, const string &, simpleOutputByIndex *, int,
+			simpleOutputTypeDef *, int &, vector <int> &);
+	int timeSeriesLength(timeSeriesOutputByIndex *);
 
  protected:
 	virtual void finish();
 	virtual void finishSpecific() { };
+	virtual void handleParameterChange(const char *);
 	std::ostream & trace();
+	bool isTraceEnabled() {
+		if (traceEnabled < 0)
+			traceEnabled = (hasPar("collectTraceInfo") && par("collectTraceInfo")) ? 1 : 0;
+		return traceEnabled;
+	}
 	std::ostream & debug();
 
 	nullstream empty;
 
-	void declareOutput(const char *);
+	int declareOutput(const char *);
+	int declareOutputLabel(int, const char *);
+
+	/* Handle based collection, without any lookup by name. The handle is
+	 * returned by declareOutput and the label id by declareOutputLabel.
+	 * Use index -1 for an output without index
+	 */
+	void collectOutput(int, int, int, double amt = 1);
 
 	void collectOutput(const char *, int);
 	void collectOutput(const char *, int, const char *);
@@ -106,8 +203,26 @@ class CastaliaModule: public virtual cSimpleModule {
 		collectHistogramNocheck(descr, -1, value);
 	}
 
+	/* Time series: values are added to the bin of the current simulation
+	 * time, bins are the given window (in seconds) wide. Handle based
+	 * collection, as for simple outputs, uses index -1 for no index
+	 */
+	int declareTimeSeries(const char *, double);
+	void collectTimeSeries(int, int, double);
+	void collectTimeSeries(const char *, int, double);
+	void collectTimeSeries(const char *descr, double value) {
+		collectTimeSeriesNocheck(descr, -1, value);
+	}
+
 	void powerDrawn(double);
 
+	string parameterSignature(const char **);
+
+ public:
+	CastaliaModule():traceEnabled(-1), tracePathId(-1) { }
+	// turn tracing of this module on or off at runtime
+	void setTraceEnabled(bool enabled) { traceEnabled = enabled ? 1 : 0; }
+
 };
 
 #endif
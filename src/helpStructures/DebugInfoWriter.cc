@@ -7,14 +7,161 @@
  *                                                                          *
  *      NICTA, Locked Bag 9013, Alexandria, NSW 1435, Australia             *
  *      Attention:  License Inquiry.                                        *
- *                                                                          *  
+ *                                                                          *
  ****************************************************************************/
 
 #include "DebugInfoWriter.h"
 
-ofstream DebugInfoWriter::theFile;
+DebugInfoBuffer::DebugInfoBuffer()
+{
+	file = NULL;
+	pendingSize = 0;
+	threadRunning = false;
+	stopThread = false;
+	pthread_mutex_init(&mutex, NULL);
+	pthread_cond_init(&cond, NULL);
+}
+
+DebugInfoBuffer::~DebugInfoBuffer()
+{
+	close();
+	pthread_mutex_destroy(&mutex);
+	pthread_cond_destroy(&cond);
+}
+
+bool DebugInfoBuffer::open(const char *name, int size, bool useThread)
+{
+	close();
+	file = fopen(name, "ab");
+	if (file == NULL)
+		return false;
+	// the FILE buffer is not needed, writes are already large
+	setvbuf(file, NULL, _IONBF, 0);
+
+	if (size < 1)
+		size = DEBUG_INFO_BUFFER_SIZE;
+	active.resize(size);
+	setp(&active[0], &active[0] + active.size());
+	if (useThread) {
+		pending.resize(size);
+		pendingSize = 0;
+		stopThread = false;
+		threadRunning = (pthread_create(&thread, NULL, flushThread, this) == 0);
+	}
+	return true;
+}
+
+void DebugInfoBuffer::close()
+{
+	if (file == NULL)
+		return;
+	sync();
+	if (threadRunning) {
+		pthread_mutex_lock(&mutex);
+		stopThread = true;
+		pthread_cond_broadcast(&cond);
+		pthread_mutex_unlock(&mutex);
+		pthread_join(thread, NULL);
+		threadRunning = false;
+	}
+	fclose(file);
+	file = NULL;
+	setp(NULL, NULL);
+	vector <char>().swap(active);
+	vector <char>().swap(pending);
+}
+
+void *DebugInfoBuffer::flushThread(void *arg)
+{
+	DebugInfoBuffer *b = (DebugInfoBuffer *)arg;
+	pthread_mutex_lock(&b->mutex);
+	while (true) {
+		while (b->pendingSize == 0 && !b->stopThread)
+			pthread_cond_wait(&b->cond, &b->mutex);
+		if (b->pendingSize == 0)
+			break;
+		// the pending buffer is not touched by the simulation until it is written
+		size_t size = b->pendingSize;
+		pthread_mutex_unlock(&b->mutex);
+		fwrite(&b->pending[0], 1, size, b->file);
+		pthread_mutex_lock(&b->mutex);
+		b->pendingSize = 0;
+		pthread_cond_broadcast(&b->cond);
+	}
+	pthread_mutex_unlock(&b->mutex);
+	return NULL;
+}
+
+void DebugInfoBuffer::waitForPending()
+{
+	pthread_mutex_lock(&mutex);
+	while (pendingSize > 0)
+		pthread_cond_wait(&cond, &mutex);
+	pthread_mutex_unlock(&mutex);
+}
+
+/* Passes the collected data on: to the flush thread, swapping the buffers,
+ * or directly to the file when there is no thread
+ */
+void DebugInfoBuffer::handOver()
+{
+	size_t used = pptr() - pbase();
+	if (used == 0 || file == NULL)
+		return;
+	if (!threadRunning) {
+		fwrite(pbase(), 1, used, file);
+	} else {
+		pthread_mutex_lock(&mutex);
+		while (pendingSize > 0)
+			pthread_cond_wait(&cond, &mutex);
+		active.swap(pending);
+		pendingSize = used;
+		pthread_cond_broadcast(&cond);
+		pthread_mutex_unlock(&mutex);
+	}
+	setp(&active[0], &active[0] + active.size());
+}
+
+int DebugInfoBuffer::overflow(int c)
+{
+	if (file == NULL)
+		return EOF;
+	handOver();
+	if (c != EOF) {
+		*pptr() = (char)c;
+		pbump(1);
+	}
+	return c == EOF ? 0 : c;
+}
+
+int DebugInfoBuffer::sync()
+{
+	if (file == NULL)
+		return 0;
+	handOver();
+	if (threadRunning)
+		waitForPending();
+	return fflush(file) == 0 ? 0 : -1;
+}
+
+DebugInfoBuffer DebugInfoWriter::theBuffer;
+ostream DebugInfoWriter::theStream(&theBuffer);
 string DebugInfoWriter::fileName;
 
+bool DebugInfoWriter::binary = false;
+int DebugInfoWriter::bufferSize = DEBUG_INFO_BUFFER_SIZE;
+bool DebugInfoWriter::useFlushThread = false;
+
+vector <string> DebugInfoWriter::strings;
+map <string, int> DebugInfoWriter::stringIds;
+int DebugInfoWriter::stringsWritten = 0;
+
+ostringstream DebugInfoWriter::record;
+bool DebugInfoWriter::recordOpen = false;
+int64 DebugInfoWriter::recordTime = 0;
+int DebugInfoWriter::recordModule = -1;
+int DebugInfoWriter::recordString = -1;
+
 DebugInfoWriter::DebugInfoWriter(const string & fName)
 {
 	fileName = fName;
@@ -25,17 +172,116 @@ void DebugInfoWriter::setDebugFileName(const string & fName)
 	fileName = fName;
 }
 
-ofstream & DebugInfoWriter::getStream(void)
+void DebugInfoWriter::setOutputOptions(const string & format, int bufSize, bool flushThread)
 {
-	if (!theFile.is_open())
-		theFile.open(fileName.c_str(), ios::app);
-	theFile.setf(ios::left);
+	if (format == "text")
+		binary = false;
+	else if (format == "binary")
+		binary = true;
+	else
+		opp_error("Unknown debugInfoFormat '%s', use 'text' or 'binary'", format.c_str());
+	if (bufSize < 1)
+		opp_error("debugInfoBufferSize must be positive");
+	bufferSize = bufSize;
+	useFlushThread = flushThread;
+}
+
+void DebugInfoWriter::open()
+{
+	if (!theBuffer.open(fileName.c_str(), bufferSize, useFlushThread)) {
+		theStream.setstate(ios::badbit);
+		return;
+	}
+	theStream.clear();
+	theStream.setf(ios::left);
+	record.setf(ios::left);
+	if (binary) {
+		int header[2] = { DEBUG_INFO_VERSION, SimTime::getScaleExp() };
+		write(DEBUG_INFO_MAGIC, 4);
+		write(header, sizeof(header));
+		// the string table starts over with every header
+		stringsWritten = 0;
+	}
+}
 
-	return theFile;
+int DebugInfoWriter::internString(const string & str)
+{
+	map <string, int>::iterator it = stringIds.find(str);
+	if (it != stringIds.end())
+		return it->second;
+	int id = strings.size();
+	strings.push_back(str);
+	stringIds[str] = id;
+	return id;
+}
+
+/* Writes the pending trace line in binary mode, preceded by the string
+ * table entries that are not in the file yet
+ */
+void DebugInfoWriter::writeRecord()
+{
+	if (!recordOpen)
+		return;
+	recordOpen = false;
+	for (; stringsWritten < (int)strings.size(); stringsWritten++) {
+		const string & str = strings[stringsWritten];
+		int entry[2] = { stringsWritten, (int)str.size() };
+		theBuffer.sputc(DEBUG_INFO_STRING_RECORD);
+		write(entry, sizeof(entry));
+		write(str.data(), str.size());
+	}
+	string payload = record.str();
+	int fields[3] = { recordModule, recordString, (int)payload.size() };
+	theBuffer.sputc(DEBUG_INFO_TRACE_RECORD);
+	write(&recordTime, sizeof(recordTime));
+	write(fields, sizeof(fields));
+	write(payload.data(), payload.size());
+}
+
+/* Direct access to the output. In binary mode this is the payload of the
+ * current trace line
+ */
+ostream & DebugInfoWriter::getStream(void)
+{
+	if (!theBuffer.isOpen())
+		open();
+	if (binary)
+		return record;
+	return theStream;
+}
+
+ostream & DebugInfoWriter::getStream(simtime_t time, int moduleId, int pathId)
+{
+	if (!theBuffer.isOpen())
+		open();
+	if (!binary)
+		return theStream << "\n" << setw(18) << time << setw(40) << strings[pathId] << " ";
+
+	writeRecord();
+	record.str("");
+	recordOpen = true;
+	recordTime = SIMTIME_RAW(time);
+	recordModule = moduleId;
+	recordString = pathId;
+	return record;
+}
+
+void DebugInfoWriter::flushStream(void)
+{
+	if (!theBuffer.isOpen())
+		return;
+	writeRecord();
+	theStream.flush();
 }
 
+/* Closes the file, once per run from the finish of the wireless channel.
+ * Modules that trace while finishing after it open the file again, with a
+ * new header
+ */
 void DebugInfoWriter::closeStream(void)
 {
-	if (theFile.is_open())
-		theFile.close();
+	if (!theBuffer.isOpen())
+		return;
+	writeRecord();
+	theBuffer.close();
 }
@@ -7,25 +7,116 @@
  *                                                                          *
  *      NICTA, Locked Bag 9013, Alexandria, NSW 1435, Australia             *
  *      Attention:  License Inquiry.                                        *
- *                                                                          *  
+ *                                                                          *
  ****************************************************************************/
 
 #ifndef DEBUGINFOWRITER_H_
 #define DEBUGINFOWRITER_H_
 
+#include <omnetpp.h>
 #include <iostream>
 #include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <map>
+#include <cstdio>
+#include <pthread.h>
 using namespace std;
 
+#define DEBUG_INFO_BUFFER_SIZE 1048576	// default buffer size in bytes
+
+/* Binary trace format, decoded offline by bin/CastaliaTraceDecode. Each time
+ * the file is opened a header is written: magic "CDBG", version and the
+ * simulation time scale exponent (32 bit integers). It is followed by records
+ * that start with a one byte tag:
+ *	'S' string table entry: id, length (32 bit integers) and the string
+ *	'T' trace line: raw simulation time (64 bit), module id, string id of the
+ *	    module path and payload length (32 bit integers) and the payload text
+ * All values are in the byte order of the machine running the simulation.
+ */
+#define DEBUG_INFO_MAGIC "CDBG"
+#define DEBUG_INFO_VERSION 1
+#define DEBUG_INFO_STRING_RECORD 'S'
+#define DEBUG_INFO_TRACE_RECORD 'T'
+
+/* Output buffer of the trace file. Data is collected in a large user space
+ * buffer and written to the file only when the buffer is full. With the
+ * flush thread enabled the full buffer is handed over to a background thread
+ * that writes it, while tracing continues in a second buffer. The handover
+ * is protected by a mutex, so the simulation only waits for the disk when
+ * the previous buffer has not been written yet.
+ */
+class DebugInfoBuffer: public streambuf {
+ private:
+	FILE *file;
+	vector <char> active;
+	vector <char> pending;
+	size_t pendingSize;	// bytes of pending buffer not written yet
+
+	bool threadRunning;
+	bool stopThread;
+	pthread_t thread;
+	pthread_mutex_t mutex;
+	pthread_cond_t cond;
+
+	static void *flushThread(void *);
+	void handOver();
+	void waitForPending();
+
+ protected:
+	virtual int overflow(int);
+	virtual int sync();
+
+ public:
+	DebugInfoBuffer();
+	~DebugInfoBuffer();
+	bool open(const char *, int, bool);
+	bool isOpen() { return file != NULL; }
+	void close();
+};
+
 class DebugInfoWriter {
  private:
-	static ofstream theFile;
+	static DebugInfoBuffer theBuffer;
+	static ostream theStream;
 	static string fileName;
 
+	static bool binary;
+	static int bufferSize;
+	static bool useFlushThread;
+
+	static vector <string> strings;	// string table, by id
+	static map <string, int> stringIds;
+	static int stringsWritten;	// entries of the table already in the file
+
+	/* binary mode keeps the trace line being written, it is completed
+	 * when the next line starts or the stream is closed
+	 */
+	static ostringstream record;
+	static bool recordOpen;
+	static int64 recordTime;
+	static int recordModule;
+	static int recordString;
+
+	static void open();
+	static void writeRecord();
+	static void write(const void *data, int size) {
+		theBuffer.sputn((const char *)data, size);
+	}
+
  public:
 	DebugInfoWriter(const string & fName);
 	static void setDebugFileName(const string & fName);
-	static ofstream & getStream(void);
+	// options are applied the next time the file is opened
+	static void setOutputOptions(const string & format, int bufSize, bool flushThread);
+	static int internString(const string &);
+	static ostream & getStream(void);
+	// starts a new trace line of the given module, path is an interned string id
+	static ostream & getStream(simtime_t time, int moduleId, int pathId);
+	// writes out what is buffered, the file stays open
+	static void flushStream(void);
 	static void closeStream(void);
 };
 
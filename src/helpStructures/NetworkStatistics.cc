@@ -0,0 +1,104 @@
+/**
+ * @file NetworkStatistics.cc
+ * @date 2026-10-18
+ *
+ * This file is distributed under the terms in the attached LICENSE file.
+ */
+
+#include "NetworkStatistics.h"
+#include "ResultWriter.h"
+
+Define_Module(NetworkStatistics);
+
+NetworkStatistics *NetworkStatistics::instance = NULL;
+
+/* The instance is known as soon as the network is built, so nodes can
+ * report from their own initialize(), whatever the initialization order
+ */
+NetworkStatistics::NetworkStatistics()
+{
+	instance = this;
+}
+
+NetworkStatistics::~NetworkStatistics()
+{
+	if (instance == this)
+		instance = NULL;
+}
+
+NetworkStatistics *NetworkStatistics::getInstance()
+{
+	if (!instance)
+		opp_error("NetworkStatistics module not found in the network");
+	return instance;
+}
+
+void NetworkStatistics::handleMessage(cMessage * msg)
+{
+	opp_error("NetworkStatistics module does not expect any messages");
+}
+
+/* The module is the last one of the network, so it finishes after all the
+ * nodes have written their results, and the result file is closed at the
+ * end of every run
+ */
+void NetworkStatistics::finish()
+{
+	CastaliaModule::finish();
+	ResultWriter::closeStream();
+}
+
+// latest energy figures of a node, in Joules
+void NetworkStatistics::reportEnergy(int node, double initial, double remaining)
+{
+	if (node < 0)
+		return;
+	if (node >= (int)initialEnergy.size()) {
+		initialEnergy.resize(node + 1, 0.0);
+		remainingEnergy.resize(node + 1, 0.0);
+		energyReported.resize(node + 1, false);
+	}
+	initialEnergy[node] = initial;
+	remainingEnergy[node] = remaining;
+	energyReported[node] = true;
+}
+
+/* Estimated network lifetime in days: the lowest lifetime of any node,
+ * extrapolated from the energy it spent so far. Nodes that spent nothing
+ * give no estimate, -1 is returned if no node did
+ */
+double NetworkStatistics::getNetworkLifetime()
+{
+	double minLifetime = -1;
+	for (int i = 0; i < (int)initialEnergy.size(); i++) {
+		double consumed = initialEnergy[i] - remainingEnergy[i];
+		if (!energyReported[i] || consumed <= 0)
+			continue;
+		double lifetime = (initialEnergy[i] * simTime().dbl()) / (consumed * 86400.0);
+		if (minLifetime < 0 || lifetime < minLifetime)
+			minLifetime = lifetime;
+	}
+	return minLifetime;
+}
+
+void NetworkStatistics::reportPacketSent(const string & app, int source, int destination)
+{
+	traffic[app].packetsSent[destination][source]++;
+}
+
+// bytes received by the final destination of a packet from source
+void NetworkStatistics::reportBytesReceived(const string & app, int source, int bytes)
+{
+	traffic[app].bytesDelivered[source] += bytes;
+}
+
+// packets sent to destination, by source node
+const map <int, int> & NetworkStatistics::getPacketsSentTo(const string & app, int destination)
+{
+	return traffic[app].packetsSent[destination];
+}
+
+long NetworkStatistics::getBytesDelivered(const string & app, int source)
+{
+	return traffic[app].bytesDelivered[source];
+}
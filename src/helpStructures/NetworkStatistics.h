@@ -0,0 +1,55 @@
+/**
+ * @file NetworkStatistics.h
+ * @date 2026-10-18
+ *
+ * This file is distributed under the terms in the attached LICENSE file.
+ */
+
+#ifndef _NETWORKSTATISTICS_H_
+#define _NETWORKSTATISTICS_H_
+
+#include <map>
+#include <vector>
+#include "CastaliaModule.h"
+
+using namespace std;
+
+// traffic of one application (by applicationID) across the network
+struct ApplicationTraffic {
+	map <int, map <int, int> > packetsSent;	// by destination, then by source
+	map <int, long> bytesDelivered;	// by source, bytes received by final destinations
+};
+
+/* Singleton module of the network. Nodes report into it during the run, and
+ * network wide figures are computed from what was reported, in a single
+ * pass, instead of every node walking the topology at finish.
+ */
+class NetworkStatistics: public CastaliaModule {
+ private:
+	static NetworkStatistics *instance;
+
+	vector <double> initialEnergy;	// by node index
+	vector <double> remainingEnergy;
+	vector <bool> energyReported;
+
+	map <string, ApplicationTraffic> traffic;	// by application ID
+
+ protected:
+	virtual void handleMessage(cMessage *);
+	virtual void finish();
+
+ public:
+	NetworkStatistics();
+	~NetworkStatistics();
+	static NetworkStatistics *getInstance();
+
+	void reportEnergy(int, double, double);
+	double getNetworkLifetime();
+
+	void reportPacketSent(const string &, int, int);
+	void reportBytesReceived(const string &, int, int);
+	const map <int, int> & getPacketsSentTo(const string &, int);
+	long getBytesDelivered(const string &, int);
+};
+
+#endif				// _NETWORKSTATISTICS_H_
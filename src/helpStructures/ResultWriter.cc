@@ -0,0 +1,112 @@
+/**
+ * @file ResultWriter.cc
+ * @date 2026-10-18
+ *
+ * This file is distributed under the terms in the attached LICENSE file.
+ */
+
+#include "ResultWriter.h"
+
+// the buffer is defined first, so it outlives the file flushed at exit
+vector <char> ResultWriter::buffer;
+ofstream ResultWriter::theFile;
+string ResultWriter::fileName;
+map <string, int> ResultWriter::stringIds;
+int ResultWriter::currentRun = -1;
+
+void ResultWriter::setResultFileName(const string & fName)
+{
+	if (fName != fileName)
+		closeStream();
+	fileName = fName;
+}
+
+void ResultWriter::open()
+{
+	buffer.resize(RESULT_BUFFER_SIZE);
+	theFile.rdbuf()->pubsetbuf(&buffer[0], buffer.size());
+	theFile.open(fileName.c_str(), ios::app | ios::binary);
+	if (!theFile.is_open())
+		opp_error("Unable to open result file %s", fileName.c_str());
+
+	int version = RESULT_VERSION;
+	write(RESULT_MAGIC, 4);
+	write(&version, sizeof(version));
+	// string table and runs start over with every header
+	stringIds.clear();
+	currentRun = -1;
+}
+
+/* Starts a record, preceded by the start of the run if this is the first
+ * record of a new run
+ */
+void ResultWriter::startRecord(char tag)
+{
+	if (!theFile.is_open())
+		open();
+	int run = ev.getConfigEx()->getActiveRunNumber();
+	if (run != currentRun) {
+		theFile.flush();
+		currentRun = run;
+		theFile.put(RESULT_RUN_RECORD);
+		write(&run, sizeof(run));
+	}
+	theFile.put(tag);
+}
+
+int ResultWriter::internString(const string & str)
+{
+	if (!theFile.is_open())
+		open();
+	map <string, int>::iterator it = stringIds.find(str);
+	if (it != stringIds.end())
+		return it->second;
+
+	int entry[2] = { (int)stringIds.size(), (int)str.size() };
+	stringIds[str] = entry[0];
+	theFile.put(RESULT_STRING_RECORD);
+	write(entry, sizeof(entry));
+	write(str.data(), str.size());
+	return entry[0];
+}
+
+void ResultWriter::writeOutput(int module, int name, int index, int label, double value)
+{
+	int fields[4] = { module, name, index, label };
+	startRecord(RESULT_OUTPUT_RECORD);
+	write(fields, sizeof(fields));
+	write(&value, sizeof(value));
+}
+
+void ResultWriter::writeHistogram(int module, int name, int index,
+		double min, double max, const vector <int> & buckets)
+{
+	int fields[3] = { module, name, index };
+	int numBuckets = buckets.size();
+	startRecord(RESULT_HISTOGRAM_RECORD);
+	write(fields, sizeof(fields));
+	write(&min, sizeof(min));
+	write(&max, sizeof(max));
+	write(&numBuckets, sizeof(numBuckets));
+	if (numBuckets > 0)
+		write(&buckets[0], numBuckets * sizeof(int));
+}
+
+void ResultWriter::writeTimeSeries(int module, int name, int index,
+		double window, const vector <double> & bins)
+{
+	int fields[3] = { module, name, index };
+	int numBins = bins.size();
+	startRecord(RESULT_TIMESERIES_RECORD);
+	write(fields, sizeof(fields));
+	write(&window, sizeof(window));
+	write(&numBins, sizeof(numBins));
+	if (numBins > 0)
+		write(&bins[0], numBins * sizeof(double));
+}
+
+void ResultWriter::closeStream(void)
+{
+	if (theFile.is_open())
+		theFile.close();
+}
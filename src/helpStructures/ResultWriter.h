@@ -0,0 +1,71 @@
+/**
+ * @file ResultWriter.h
+ * @date 2026-10-18
+ *
+ * This file is distributed under the terms in the attached LICENSE file.
+ */
+
+#ifndef RESULTWRITER_H_
+#define RESULTWRITER_H_
+
+#include <omnetpp.h>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <map>
+using namespace std;
+
+#define RESULT_BUFFER_SIZE 1048576
+
+/* Structured result file, used instead of the text printed through EV when
+ * resultFileName is set. bin/CastaliaResults reads it directly. Each time the
+ * file is opened a header is written: magic "CRES" and version (32 bit
+ * integers). It is followed by records that start with a one byte tag:
+ *	'R' start of a run: run number
+ *	'S' string table entry: id, length and the string
+ *	'O' simple output: module path, output name, index, label (string ids,
+ *	    index is -1 for outputs without index) and the value (double)
+ *	'H' histogram: module path, output name, index, min and max (doubles),
+ *	    number of buckets and the bucket values
+ *	'T' time series: module path, output name, index, window (double),
+ *	    number of bins and the bin values (doubles)
+ * All integers are 32 bit, in the byte order of the machine running the
+ * simulation. Records are written as each module finishes, nothing is kept
+ * in memory besides the string table.
+ */
+#define RESULT_MAGIC "CRES"
+#define RESULT_VERSION 1
+#define RESULT_RUN_RECORD 'R'
+#define RESULT_STRING_RECORD 'S'
+#define RESULT_OUTPUT_RECORD 'O'
+#define RESULT_HISTOGRAM_RECORD 'H'
+#define RESULT_TIMESERIES_RECORD 'T'
+
+class ResultWriter {
+ private:
+	static ofstream theFile;
+	static string fileName;
+	static vector <char> buffer;
+	static map <string, int> stringIds;
+	static int currentRun;
+
+	static void open();
+	static void startRecord(char);
+	static void write(const void *data, int size) {
+		theFile.write((const char *)data, size);
+	}
+
+ public:
+	// empty file name keeps the text output
+	static void setResultFileName(const string & fName);
+	static bool isEnabled() { return !fileName.empty(); }
+	static int internString(const string &);
+	static void writeOutput(int module, int name, int index, int label, double value);
+	static void writeHistogram(int module, int name, int index,
+			double min, double max, const vector <int> & buckets);
+	static void writeTimeSeries(int module, int name, int index,
+			double window, const vector <double> & bins);
+	static void closeStream(void);
+};
+
+#endif				/*RESULTWRITER_H_ */
@@ -156,7 +156,7 @@ void VirtualApplication::handleMessage(cMessage * msg)
 void VirtualApplication::finish()
 {
 	CastaliaModule::finish();
-	DebugInfoWriter::closeStream();
+	DebugInfoWriter::flushStream();
 }
 
 ApplicationPacket* VirtualApplication::createGenericDataPacket(double data, unsigned int seqNum, int size)
@@ -5,6 +5,7 @@
  */
 
 #include "FloodApp.h"
+#include "NetworkStatistics.h"
 
 Define_Module(FloodApp);
 
@@ -34,9 +35,7 @@ void FloodApp::startup() {
 	numNodes = getParentModule()->getParentModule()->par("numNodes");
 
 	// Is it necessary?
-	packetsSent.clear();
 	packetsReceived.clear();
-	bytesReceived.clear();
 
 	if (recipientAddress.compare(SELF_NETWORK_ADDRESS) != 0) {
 		std::fprintf(log, "Device is NOT Sink\n");
@@ -74,7 +73,8 @@ void FloodApp::fromNetworkLayer(ApplicationPacket* rcvPacket, const char* source
 			trace() << "Received packet #" << sequenceNumber << " from node " << source;
 			collectOutput("Packets received per node", sourceId);
 			packetsReceived[sourceId]++;
-			bytesReceived[sourceId] += rcvPacket->getByteLength();
+			NetworkStatistics::getInstance()->reportBytesReceived(applicationID,
+				sourceId, rcvPacket->getByteLength());
 		}
 		
 		else {
@@ -101,7 +101,7 @@ void FloodApp::timerFiredCallback(int index) {
 		std::fprintf(log, "Sending packet %s\n", name);
 		packet->setName(name);
 		toNetworkLayer(packet, recipientAddress.c_str());
-		packetsSent[recipientId]++;
+		NetworkStatistics::getInstance()->reportPacketSent(applicationID, self, recipientId);
 		dataSN++;
 		setTimer(SEND_PACKET, packet_spacing);
 
@@ -129,25 +129,15 @@ void FloodApp::finishSpecific() {
 	declareOutput("Packets reception rate");
 	declareOutput("Packets loss rate");
 
-	cTopology* topo;	// temp variable to access packets received by other nodes
-	topo = new cTopology("topo");
-	topo->extractByNedTypeName(cStringTokenizer("node.Node").asVector());
-
-	long bytesDelivered = 0;
-	for (int i = 0; i < numNodes; i++) {
-		FloodApp* appModule = dynamic_cast<FloodApp*>(topo->getNode(i)->getModule()->getSubmodule("Application"));
-		if (appModule) {
-			int packetsSent = appModule->getPacketsSent(self);
-			if (packetsSent > 0) { // this node sent us some packets
-				float rate = (float)packetsReceived[i]/packetsSent;
-				collectOutput("Packets reception rate", i, "total", rate);
-				collectOutput("Packets loss rate", i, "total", 1-rate);
-			}
-
-			bytesDelivered += appModule->getBytesReceived(self);
-		}
+	// packets other nodes sent us, and bytes of ours they received, as reported during the run
+	NetworkStatistics* statistics = NetworkStatistics::getInstance();
+	const std::map<int,int>& sentToSelf = statistics->getPacketsSentTo(applicationID, self);
+	for (std::map<int,int>::const_iterator i = sentToSelf.begin(); i != sentToSelf.end(); i++) {
+		float rate = (float)packetsReceived[i->first]/i->second;
+		collectOutput("Packets reception rate", i->first, "total", rate);
+		collectOutput("Packets loss rate", i->first, "total", 1-rate);
 	}
-	delete(topo);
+	long bytesDelivered = statistics->getBytesDelivered(applicationID, self);
 
 	if (bytesDelivered > 0) {
 		double energy = (resMgrModule->getSpentEnergy() * 1000000000)/(bytesDelivered * 8);	//in nanojoules/bit
@@ -34,8 +34,6 @@ private:
 	//variables below are used to determine the packet delivery rates.	
 	int numNodes;
 	std::map<long,int> packetsReceived;
-	std::map<long,int> bytesReceived;
-	std::map<long,int> packetsSent;
 
 protected:
 	void startup();
@@ -43,11 +41,6 @@ protected:
 	void handleRadioControlMessage(RadioControlMessage*);
 	void timerFiredCallback(int);
 	void finishSpecific();
-
-public:
-	int getPacketsSent(int addr) { return packetsSent[addr]; }
-	int getPacketsReceived(int addr) { return packetsReceived[addr]; }
-	int getBytesReceived(int addr) { return bytesReceived[addr]; }
 	
 };
 
@@ -11,6 +11,7 @@
  ****************************************************************************/
 
 #include "ThroughputTest.h"
+#include "NetworkStatistics.h"
 
 Define_Module(ThroughputTest);
 
@@ -25,9 +26,7 @@ void ThroughputTest::startup()
 	dataSN = 0;
 	
 	numNodes = getParentModule()->getParentModule()->par("numNodes");
-	packetsSent.clear();
 	packetsReceived.clear();
-	bytesReceived.clear();
 
 	if (packet_spacing > 0 && recipientAddress.compare(SELF_NETWORK_ADDRESS) != 0)
 		setTimer(SEND_PACKET, packet_spacing + startupDelay);
@@ -35,6 +34,9 @@ void ThroughputTest::startup()
 		trace() << "Not sending packets";
 
 	declareOutput("Packets received per node");
+	double throughputWindow = par("throughputWindow");
+	throughputSeries = throughputWindow > 0 ?
+		declareTimeSeries("Bytes received over time", throughputWindow) : -1;
 }
 
 void ThroughputTest::fromNetworkLayer(ApplicationPacket * rcvPacket,
@@ -49,7 +51,9 @@ void ThroughputTest::fromNetworkLayer(ApplicationPacket * rcvPacket,
 			trace() << "Received packet #" << sequenceNumber << " from node " << source;
 			collectOutput("Packets received per node", sourceId);
 			packetsReceived[sourceId]++;
-			bytesReceived[sourceId] += rcvPacket->getByteLength();
+			NetworkStatistics::getInstance()->reportBytesReceived(applicationID,
+				sourceId, rcvPacket->getByteLength());
+			collectTimeSeries(throughputSeries, -1, rcvPacket->getByteLength());
 		} else {
 			trace() << "Packet #" << sequenceNumber << " from node " << source <<
 				" exceeded delay limit of " << delayLimit << "s";
@@ -69,7 +73,7 @@ void ThroughputTest::timerFiredCallback(int index)
 		case SEND_PACKET:{
 			trace() << "Sending packet #" << dataSN;
 			toNetworkLayer(createGenericDataPacket(0, dataSN), recipientAddress.c_str());
-			packetsSent[recipientId]++;
+			NetworkStatistics::getInstance()->reportPacketSent(applicationID, self, recipientId);
 			dataSN++;
 			setTimer(SEND_PACKET, packet_spacing);
 			break;
@@ -92,26 +96,15 @@ void ThroughputTest::finishSpecific() {
 	declareOutput("Packets reception rate");
 	declareOutput("Packets loss rate");
 
-	cTopology *topo;	// temp variable to access packets received by other nodes
-	topo = new cTopology("topo");
-	topo->extractByNedTypeName(cStringTokenizer("node.Node").asVector());
-
-	long bytesDelivered = 0;
-	for (int i = 0; i < numNodes; i++) {
-		ThroughputTest *appModule = dynamic_cast<ThroughputTest*>
-			(topo->getNode(i)->getModule()->getSubmodule("Application"));
-		if (appModule) {
-			int packetsSent = appModule->getPacketsSent(self);
-			if (packetsSent > 0) { // this node sent us some packets
-				float rate = (float)packetsReceived[i]/packetsSent;
-				collectOutput("Packets reception rate", i, "total", rate);
-				collectOutput("Packets loss rate", i, "total", 1-rate);
-			}
-
-			bytesDelivered += appModule->getBytesReceived(self);
-		}
+	// packets other nodes sent us, and bytes of ours they received, as reported during the run
+	NetworkStatistics *statistics = NetworkStatistics::getInstance();
+	const map<int,int> &sentToSelf = statistics->getPacketsSentTo(applicationID, self);
+	for (map<int,int>::const_iterator i = sentToSelf.begin(); i != sentToSelf.end(); i++) {
+		float rate = (float)packetsReceived[i->first]/i->second;
+		collectOutput("Packets reception rate", i->first, "total", rate);
+		collectOutput("Packets loss rate", i->first, "total", 1-rate);
 	}
-	delete(topo);
+	long bytesDelivered = statistics->getBytesDelivered(applicationID, self);
 
 	if (packet_rate > 0 && bytesDelivered > 0) {
 		double energy = (resMgrModule->getSpentEnergy() * 1000000000)/(bytesDelivered * 8);	//in nanojoules/bit
@@ -30,13 +30,12 @@ class ThroughputTest: public VirtualApplication {
 	float packet_spacing;
 	int dataSN;
 	int recipientId;
+	int throughputSeries;	// time series handle, -1 if not collected
 	string recipientAddress;
 	
 	//variables below are used to determine the packet delivery rates.	
 	int numNodes;
 	map<long,int> packetsReceived;
-	map<long,int> bytesReceived;
-	map<long,int> packetsSent;
 
  protected:
 	void startup();
@@ -44,11 +43,6 @@ class ThroughputTest: public VirtualApplication {
 	void handleRadioControlMessage(RadioControlMessage *);
 	void timerFiredCallback(int);
 	void finishSpecific();
-
- public:
-	int getPacketsSent(int addr) { return packetsSent[addr]; }
-	int getPacketsReceived(int addr) { return packetsReceived[addr]; }
-	int getBytesReceived(int addr) { return bytesReceived[addr]; }
 	
 };
 
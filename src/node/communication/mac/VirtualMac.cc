@@ -37,7 +37,7 @@ void VirtualMac::initialize()
 
 int VirtualMac::handleControlCommand(cMessage * msg)
 {
-	trace() << "WARNING: handleControlCommand not defined in this module";
+	TRACE << "WARNING: handleControlCommand not defined in this module";
 	return 0;
 }
 
@@ -59,7 +59,7 @@ int VirtualMac::bufferPacket(cPacket * rcvFrame)
 		return 0;
 	} else {
 		TXBuffer.push(rcvFrame);
-		trace() << "Packet buffered from network layer, buffer state: "
+		TRACE << "Packet buffered from network layer, buffer state: "
 		    << TXBuffer.size() << "/" << macBufferSize;
 		return 1;
 	}
@@ -87,7 +87,7 @@ void VirtualMac::handleMessage(cMessage * msg)
 		case NETWORK_LAYER_PACKET:{
 			RoutingPacket *pkt = check_and_cast <RoutingPacket*>(msg);
 			if (macMaxFrameSize > 0 && macMaxFrameSize < pkt->getByteLength() + macFrameOverhead) {
-				trace() << "Oversized packet dropped. Size:" << pkt->getByteLength() <<
+				TRACE << "Oversized packet dropped. Size:" << pkt->getByteLength() <<
 						", MAC layer overhead:" << macFrameOverhead <<
 						", max MAC frame size:" << macMaxFrameSize;
 				break;
@@ -165,7 +165,7 @@ void VirtualMac::finish()
 
 void VirtualMac::toNetworkLayer(cMessage * macMsg)
 {
-	trace() << "Delivering [" << macMsg->getName() << "] to Network layer";
+	TRACE << "Delivering [" << macMsg->getName() << "] to Network layer";
 	send(macMsg, "toNetworkModule");
 }
 
@@ -32,7 +32,7 @@ void BaselineBANMac::startup() {
 		connectedHID = UNCONNECTED;
  		connectedNID = UNCONNECTED;
 		unconnectedNID = 1 + genk_intrand(0,14);    //we select random unconnected NID
-		trace() << "Selected random unconnected NID " << unconnectedNID;
+		TRACE << "Selected random unconnected NID " << unconnectedNID;
 		scheduledAccessLength = par("scheduledAccessLength");
 		scheduledAccessPeriod = par("scheduledAccessPeriod");
 		pastSyncIntervalNominal = false;
@@ -119,7 +119,7 @@ void BaselineBANMac::timerFiredCallback(int index) {
 		}
 
 		case ACK_TIMEOUT: {
-			trace() << "ACK timeout fired";
+			TRACE << "ACK timeout fired";
 			waitingForACK = false;
 
 			// double the Contention Window, after every second fail.
@@ -142,7 +142,7 @@ void BaselineBANMac::timerFiredCallback(int index) {
 		}
 
 		case START_SLEEPING: {
-			trace() << "State from "<< macState << " to MAC_SLEEP";
+			TRACE << "State from "<< macState << " to MAC_SLEEP";
 			macState = MAC_SLEEP;
 			toRadioLayer(createRadioCommand(SET_STATE,SLEEP));   isRadioSleeping = true;
 			isPollPeriod = false;
@@ -150,7 +150,7 @@ void BaselineBANMac::timerFiredCallback(int index) {
 		}
 
 		case START_SCHEDULED_TX_ACCESS: {
-			trace() << "State from "<< macState << " to MAC_FREE_TX_ACCESS (scheduled)";
+			TRACE << "State from "<< macState << " to MAC_FREE_TX_ACCESS (scheduled)";
 			macState = MAC_FREE_TX_ACCESS;
 			endTime = getClock() + (scheduledTxAccessEnd - scheduledTxAccessStart) * allocationSlotLength;
 			if (beaconPeriodLength > scheduledTxAccessEnd)
@@ -160,7 +160,7 @@ void BaselineBANMac::timerFiredCallback(int index) {
 		}
 
 		case START_SCHEDULED_RX_ACCESS: {
-			trace() << "State from "<< macState << " to MAC_FREE_RX_ACCESS (scheduled)";
+			TRACE << "State from "<< macState << " to MAC_FREE_RX_ACCESS (scheduled)";
 			macState = MAC_FREE_RX_ACCESS;
 			toRadioLayer(createRadioCommand(SET_STATE,RX));  isRadioSleeping = false;
 			if (beaconPeriodLength > scheduledRxAccessEnd)
@@ -169,7 +169,7 @@ void BaselineBANMac::timerFiredCallback(int index) {
 		}
 
 		case START_POSTED_ACCESS: {
-			trace() << "State from "<< macState << " to MAC_FREE_RX_ACCESS (post)";
+			TRACE << "State from "<< macState << " to MAC_FREE_RX_ACCESS (post)";
 			macState = MAC_FREE_RX_ACCESS;
 			toRadioLayer(createRadioCommand(SET_STATE,RX));  isRadioSleeping = false;
 			// reset the timer for sleeping as needed
@@ -185,7 +185,7 @@ void BaselineBANMac::timerFiredCallback(int index) {
 		}
 
 		case WAKEUP_FOR_BEACON: {
-			trace() << "State from "<< macState << " to MAC_BEACON_WAIT";
+			TRACE << "State from "<< macState << " to MAC_BEACON_WAIT";
 			macState = MAC_BEACON_WAIT;
 			toRadioLayer(createRadioCommand(SET_STATE,RX));  isRadioSleeping = false;
 			isPollPeriod = false;
@@ -205,8 +205,8 @@ void BaselineBANMac::timerFiredCallback(int index) {
 
 		// The rest of the timers are specific to a Hub
 		case SEND_BEACON: {
-			trace() << "BEACON SEND, next beacon in " << beaconPeriodLength * allocationSlotLength;
-			trace() << "State from "<< macState << " to MAC_RAP";
+			TRACE << "BEACON SEND, next beacon in " << beaconPeriodLength * allocationSlotLength;
+			TRACE << "State from "<< macState << " to MAC_RAP";
 			macState = MAC_RAP;
 			// We should provide for the case of the Hub sleeping. Here we ASSUME it is always ON!
 			setTimer(SEND_BEACON, beaconPeriodLength * allocationSlotLength);
@@ -244,7 +244,7 @@ void BaselineBANMac::timerFiredCallback(int index) {
 		}
 
 		case SEND_FUTURE_POLLS: {
-			trace() << "State from "<< macState << " to MAC_FREE_TX_ACCESS (send Future Polls)";
+			TRACE << "State from "<< macState << " to MAC_FREE_TX_ACCESS (send Future Polls)";
 			macState = MAC_FREE_TX_ACCESS;
 			// when we are in a state that we can TX, we should *always* set endTime
 			endTime = getClock() + allocationSlotLength;
@@ -276,7 +276,7 @@ void BaselineBANMac::timerFiredCallback(int index) {
 					pollPkt->setFragmentNumber(0);
 					pollPkt->setMoreData(1);
 					pollPkt->setByteLength(BASELINEBAN_HEADER_SIZE);
-					trace() << "Created future POLL for NID:" << nid << ", for slot "<< nextPollStart;
+					TRACE << "Created future POLL for NID:" << nid << ", for slot "<< nextPollStart;
 					nextPollStart += slotsGiven;
 					//collectOutput("Polls given", nid);
 					MgmtBuffer.push(pollPkt);
@@ -290,8 +290,8 @@ void BaselineBANMac::timerFiredCallback(int index) {
 		}
 
 		case SEND_POLL: {
-			if (hubPollTimers.empty()) {trace() << "WARNING: timer SEND_POLL with hubPollTimers NULL"; break;}
-			trace() << "State from "<< macState << " to MAC_FREE_RX_ACCESS (Poll)";
+			if (hubPollTimers.empty()) {TRACE << "WARNING: timer SEND_POLL with hubPollTimers NULL"; break;}
+			TRACE << "State from "<< macState << " to MAC_FREE_RX_ACCESS (Poll)";
 			macState = MAC_FREE_RX_ACCESS;
 			// we set the state to RX but we also need to send the POLL message.
 			TimerInfo t = hubPollTimers.front();
@@ -307,7 +307,7 @@ void BaselineBANMac::timerFiredCallback(int index) {
 			toRadioLayer(createRadioCommand(SET_STATE,TX)); isRadioSleeping = false;
 
 			collectOutput("var stats", "poll slots given", t.slotsGiven);
-			trace() << "POLL for NID: "<< t.NID <<", ending at slot: "<< t.endSlot << ", lasting: " << t.slotsGiven << " slots";
+			TRACE << "POLL for NID: "<< t.NID <<", ending at slot: "<< t.endSlot << ", lasting: " << t.slotsGiven << " slots";
 			hubPollTimers.pop();
 			// if there is another poll then it will come after this one, so scheduling the timer is easy
 			if (hubPollTimers.size() > 0) setTimer(SEND_POLL, slotsGiven * allocationSlotLength);
@@ -321,7 +321,7 @@ void BaselineBANMac::timerFiredCallback(int index) {
 		}
 
 		case HUB_SCHEDULED_ACCESS: {
-			trace() << "State from "<< macState << " to MAC_FREE_RX_ACCESS (hub)";
+			TRACE << "State from "<< macState << " to MAC_FREE_RX_ACCESS (hub)";
 			macState = MAC_FREE_RX_ACCESS;
 			// we should look at the schedule and setup timers to get in and out
 			// of MAC_FREE_RX_ACCESS MAC_FREE_TX_ACCESS and finally MAC_SLEEP
@@ -336,7 +336,7 @@ void BaselineBANMac::fromNetworkLayer(cPacket *pkt, int dst) {
 	if (bufferPacket(BaselineBANDataPkt)) {
 		attemptTX();
 	} else {
-		trace() << "WARNING BaselineBAN MAC buffer overflow";
+		TRACE << "WARNING BaselineBAN MAC buffer overflow";
 		collectOutput("Data pkt breakdown", "Fail, buffer overflow");
 	}
 }
@@ -381,21 +381,21 @@ void BaselineBANMac::fromRadioLayer(cPacket *pkt, double rssi, double lqi) {
 				 * timer to send this first POLL [the one that the (future)I_ACK_POLL points to]
 				 */
 				if (hubPollTimers.empty() || hubPollTimers.back().NID != BaselineBANPkt->getNID() ) {
-					trace() << "TEST: frameStartTime= "<<frameStartTime<<" poll from start= "<<(nextFuturePollSlot-1)*allocationSlotLength<<" timer= "<<frameStartTime + (nextFuturePollSlot-1)*allocationSlotLength - getClock();
+					TRACE << "TEST: frameStartTime= "<<frameStartTime<<" poll from start= "<<(nextFuturePollSlot-1)*allocationSlotLength<<" timer= "<<frameStartTime + (nextFuturePollSlot-1)*allocationSlotLength - getClock();
 					if (hubPollTimers.empty())
 						setTimer(SEND_POLL, frameStartTime + (nextFuturePollSlot-1)*allocationSlotLength - getClock());
 					TimerInfo t; t.NID=BaselineBANPkt->getNID(); t.slotsGiven=1; t.endSlot=nextFuturePollSlot;
 					hubPollTimers.push(t);
 					nextFuturePollSlot++;
-					trace() << "TEST: nextFuturePollSlot= " << nextFuturePollSlot;
+					TRACE << "TEST: nextFuturePollSlot= " << nextFuturePollSlot;
 					lastTxAccessSlot[t.NID].polled = t.endSlot;
 				}
 			}
 			int futurePollSlot = (naivePollingScheme ? nextFuturePollSlot : hubPollTimers.back().endSlot);
-			trace() << "Future POLL at slot " << futurePollSlot <<" inserted in ACK packet";
+			TRACE << "Future POLL at slot " << futurePollSlot <<" inserted in ACK packet";
 			ackPacket->setSequenceNumber(futurePollSlot);
 		}
-		trace() << "transmitting ACK to/from NID:" << BaselineBANPkt->getNID();
+		TRACE << "transmitting ACK to/from NID:" << BaselineBANPkt->getNID();
 		toRadioLayer(ackPacket);
 		toRadioLayer(createRadioCommand(SET_STATE,TX)); isRadioSleeping = false;
 		/* Any future attempts to TX should be done AFTER we are finished TXing
@@ -431,14 +431,14 @@ void BaselineBANMac::fromRadioLayer(cPacket *pkt, double rssi, double lqi) {
 			beaconPeriodLength = BaselineBANBeacon->getBeaconPeriodLength();
 			RAP1Length = BaselineBANBeacon->getRAP1Length();
 			if (RAP1Length > 0) {
-				trace() << "State from "<< macState << " to MAC_RAP";
+				TRACE << "State from "<< macState << " to MAC_RAP";
 				macState = MAC_RAP;
 				endTime = getClock() + RAP1Length * allocationSlotLength - beaconTxTime;
 			}
 			collectOutput("Beacons received");
-			trace() << "Beacon rx: reseting sync clock to " << SInominal << " secs";
-			trace() << "           Slot= " << allocationSlotLength << " secs, beacon period= " << beaconPeriodLength << "slots";
-			trace() << "           RAP1= " << RAP1Length << "slots, RAP ends at time: "<< endTime;
+			TRACE << "Beacon rx: reseting sync clock to " << SInominal << " secs";
+			TRACE << "           Slot= " << allocationSlotLength << " secs, beacon period= " << beaconPeriodLength << "slots";
+			TRACE << "           RAP1= " << RAP1Length << "slots, RAP ends at time: "<< endTime;
 
 			/* Flush the Management packets buffer. Delete packetToBeSent if it is a management packet
 			 * This is a design choice. It simplifies the flowcontrol and prevents rare cases where
@@ -457,7 +457,7 @@ void BaselineBANMac::fromRadioLayer(cPacket *pkt, double rssi, double lqi) {
 			if (connectedHID == UNCONNECTED) {
 				// go into a setup phase again after this beacon's RAP
 				setTimer(START_SETUP, RAP1Length * allocationSlotLength - beaconTxTime);
-				trace() << "           (unconnected): go back in setup mode when RAP ends";
+				TRACE << "           (unconnected): go back in setup mode when RAP ends";
 
 				/* We will try to connect to this BAN  if our scheduled access length
 				 * is NOT set to unconnected (-1). If it is set to 0, it means we are
@@ -487,7 +487,7 @@ void BaselineBANMac::fromRadioLayer(cPacket *pkt, double rssi, double lqi) {
 
 					// Management packets go in their own buffer, and handled by attemptTX() with priority
 					MgmtBuffer.push(connectionRequest);
-					trace() << "           (unconnected): created connection request";
+					TRACE << "           (unconnected): created connection request";
 				}
 			/* else we are connected already and previous filtering
 			 * made sure that this beacon belongs to our BAN
@@ -501,12 +501,12 @@ void BaselineBANMac::fromRadioLayer(cPacket *pkt, double rssi, double lqi) {
 				if ((scheduledTxAccessStart == UNCONNECTED && RAP1Length < beaconPeriodLength)
 								|| (scheduledTxAccessStart-1 > RAP1Length)) {
 					setTimer(START_SLEEPING, RAP1Length * allocationSlotLength - beaconTxTime);
-					trace() << "           --- start sleeping in: " << RAP1Length * allocationSlotLength - beaconTxTime << " secs";
+					TRACE << "           --- start sleeping in: " << RAP1Length * allocationSlotLength - beaconTxTime << " secs";
 				}
 				// schedule the timer to go in scheduled TX access, IF we have a valid schedule
 				if ( scheduledTxAccessEnd > scheduledTxAccessStart) {
 					setTimer(START_SCHEDULED_TX_ACCESS, (scheduledTxAccessStart-1) * allocationSlotLength - beaconTxTime + GUARD_TX_TIME);
-					trace() << "           --- start scheduled TX access in: " << (scheduledTxAccessStart-1) * allocationSlotLength - beaconTxTime + GUARD_TX_TIME << " secs";
+					TRACE << "           --- start scheduled TX access in: " << (scheduledTxAccessStart-1) * allocationSlotLength - beaconTxTime + GUARD_TX_TIME << " secs";
 				}
 				// we should also handle the case when we have a scheduled RX access. This is not implemented yet.
 			}
@@ -523,7 +523,7 @@ void BaselineBANMac::fromRadioLayer(cPacket *pkt, double rssi, double lqi) {
 			cancelTimer(ACK_TIMEOUT);
 
 			if (packetToBeSent == NULL || currentPacketTransmissions == 0){
-				trace() << "WARNING: Received I-ACK with packetToBeSent being NULL, or not TXed!";
+				TRACE << "WARNING: Received I-ACK with packetToBeSent being NULL, or not TXed!";
 				break;
 			}
 			// collect statistics
@@ -579,9 +579,9 @@ void BaselineBANMac::fromRadioLayer(cPacket *pkt, double rssi, double lqi) {
 				// set the start and end times for the schedule
 				scheduledTxAccessStart = connAssignment->getUplinkRequestStart();
 				scheduledTxAccessEnd = connAssignment->getUplinkRequestEnd();
-				trace() << "connected as NID " << connectedNID << "  --start TX access at slot: " << scheduledTxAccessStart << ", end at slot: " << scheduledTxAccessEnd;
+				TRACE << "connected as NID " << connectedNID << "  --start TX access at slot: " << scheduledTxAccessStart << ", end at slot: " << scheduledTxAccessEnd;
 			} // else we don't need to do anything - request is rejected
-			else trace() << "Connection Request REJECTED, status code: " << connAssignment->getStatusCode();
+			else TRACE << "Connection Request REJECTED, status code: " << connAssignment->getStatusCode();
 
 			break;
 		}
@@ -623,8 +623,8 @@ void BaselineBANMac::fromRadioLayer(cPacket *pkt, double rssi, double lqi) {
 				connAssignment->setAssignedNID(iter->second.NID);
 				connAssignment->setUplinkRequestStart(iter->second.startSlot);
 				connAssignment->setUplinkRequestEnd(iter->second.endSlot);
-				trace() << "Connection request seen before! Assigning stored NID and resources ...";
-				trace() << "Connection request from NID " << connRequest->getNID() << " (full addr: " << fullAddress <<") Assigning connected NID " << iter->second.NID;
+				TRACE << "Connection request seen before! Assigning stored NID and resources ...";
+				TRACE << "Connection request from NID " << connRequest->getNID() << " (full addr: " << fullAddress <<") Assigning connected NID " << iter->second.NID;
 			} else {
 				// the request has not been processed before, try to assign new resources
 				if (connRequest->getUplinkRequest() > beaconPeriodLength - (currentFirstFreeSlot-1)) {
@@ -645,7 +645,7 @@ void BaselineBANMac::fromRadioLayer(cPacket *pkt, double rssi, double lqi) {
 					connAssignment->setAssignedNID(newAssignment.NID);
 					connAssignment->setUplinkRequestStart(newAssignment.startSlot);
 					connAssignment->setUplinkRequestEnd(newAssignment.endSlot);
-					trace() << "Connection request from NID " << connRequest->getNID() << " (full addr: " << fullAddress <<") Assigning connected NID " << newAssignment.NID;
+					TRACE << "Connection request from NID " << connRequest->getNID() << " (full addr: " << fullAddress <<") Assigning connected NID " << newAssignment.NID;
 					// hub keeps track of the assignments
 					lastTxAccessSlot[currentFreeConnectedNID].scheduled = newAssignment.endSlot -1;
 					currentFirstFreeSlot += connRequest->getUplinkRequest();
@@ -655,7 +655,7 @@ void BaselineBANMac::fromRadioLayer(cPacket *pkt, double rssi, double lqi) {
 			MgmtBuffer.push(connAssignment);
 
 			// transmission will be attempted after we are done sending the I-ACK
-			trace() << "Conn assgnmnt created, wait for " << (TX_TIME(BASELINEBAN_HEADER_SIZE) + 2*pTIFS) << " to attempTX";
+			TRACE << "Conn assgnmnt created, wait for " << (TX_TIME(BASELINEBAN_HEADER_SIZE) + 2*pTIFS) << " to attempTX";
 			break;
 		}
 
@@ -670,7 +670,7 @@ void BaselineBANMac::fromRadioLayer(cPacket *pkt, double rssi, double lqi) {
 		case DISASSOCIATION:
 		case PTK:
 		case GTK: {
-			trace() << "WARNING: unimplemented packet subtype in [" << BaselineBANPkt->getName() << "]";
+			TRACE << "WARNING: unimplemented packet subtype in [" << BaselineBANPkt->getName() << "]";
 			break;
 		}
 	}
@@ -710,7 +710,7 @@ bool BaselineBANMac::isPacketForMe(BaselineMacPacket *pkt) {
 				// the packet is not for us, but the NID is the same, so we need to choose a new one.
 				unconnectedNID = 1 + genk_intrand(0,14);
 				if (packetToBeSent) packetToBeSent->setNID(unconnectedNID);
-				trace() << "Choosing NEW unconnectedNID = " << unconnectedNID;
+				TRACE << "Choosing NEW unconnectedNID = " << unconnectedNID;
 				return false;
 			}
 		}
@@ -721,10 +721,10 @@ bool BaselineBANMac::isPacketForMe(BaselineMacPacket *pkt) {
 		if ((pkt->getFrameSubtype() == I_ACK || pkt->getFrameSubtype() == I_ACK_POLL ||
 			pkt->getFrameSubtype() == B_ACK || pkt->getFrameSubtype() == B_ACK_POLL)) {
 			if (packetToBeSent == NULL || currentPacketTransmissions == 0)	{
-				trace() << "While unconnected: ACK packet received with no packet to ack, renewing NID";
+				TRACE << "While unconnected: ACK packet received with no packet to ack, renewing NID";
 				unconnectedNID = 1 + genk_intrand(0,14);
 				if (packetToBeSent) packetToBeSent->setNID(unconnectedNID);
-				trace() << "Choosing NEW unconnectedNID = " << unconnectedNID;
+				TRACE << "Choosing NEW unconnectedNID = " << unconnectedNID;
 				return false;
 			}
 		}
@@ -776,7 +776,7 @@ void BaselineBANMac::attemptTxInRAP() {
 	if (backoffCounter == 0) {
 		backoffCounter = 1 + genk_intrand(0,CW);
 	}
-	trace() << "Starting to transmit " << packetToBeSent->getName() << " in RAP, backoffCounter " << backoffCounter;
+	TRACE << "Starting to transmit " << packetToBeSent->getName() << " in RAP, backoffCounter " << backoffCounter;
 	attemptingToTX = true;
 	setTimer(CARRIER_SENSING,0);
 }
@@ -802,7 +802,7 @@ void BaselineBANMac::attemptTX() {
 	 * then delete it, reset relevant variables, and collect stats.
 	 */
 	if (packetToBeSent) {
-		trace() << "Max TX attempts reached. Last attempt was a CS fail";
+		TRACE << "Max TX attempts reached. Last attempt was a CS fail";
 		if (currentPacketCSFails == maxPacketTries){
 			if (packetToBeSent->getFrameType() == DATA)
 				collectOutput("Data pkt breakdown", "Failed, Channel busy");
@@ -822,7 +822,7 @@ void BaselineBANMac::attemptTX() {
 	if (MgmtBuffer.size() !=0) {
 		packetToBeSent = (BaselineMacPacket*)MgmtBuffer.front();  MgmtBuffer.pop();
 		if (MgmtBuffer.size() > MGMT_BUFFER_SIZE)
-			trace() << "WARNING: Management buffer reached a size of " << MgmtBuffer.size();
+			TRACE << "WARNING: Management buffer reached a size of " << MgmtBuffer.size();
 	} else if (connectedNID != UNCONNECTED && TXBuffer.size() != 0) {
 		packetToBeSent = (BaselineMacPacket*)TXBuffer.front();   TXBuffer.pop();
 		setHeaderFields(packetToBeSent, I_ACK_POLICY, DATA, RESERVED);
@@ -867,7 +867,7 @@ void BaselineBANMac::sendPacket() {
 		 * timers are just scheduled on the face value. We also take into account sleep->TX delay, which
 		 * the BaselineBAN spec does not mention but it is important.
 		 */
-		trace() << "TXing[" << packetToBeSent->getName() << "], ACK_TIMEOUT in " << (SLEEP2TX + TX_TIME(packetToBeSent->getByteLength()) + 2*pTIFS + TX_TIME(BASELINEBAN_HEADER_SIZE)) * (1 + mClockAccuracy);
+		TRACE << "TXing[" << packetToBeSent->getName() << "], ACK_TIMEOUT in " << (SLEEP2TX + TX_TIME(packetToBeSent->getByteLength()) + 2*pTIFS + TX_TIME(BASELINEBAN_HEADER_SIZE)) * (1 + mClockAccuracy);
 		setTimer(ACK_TIMEOUT, (SLEEP2TX + TX_TIME(packetToBeSent->getByteLength()) + 2*pTIFS + TX_TIME(BASELINEBAN_HEADER_SIZE)) * (1 + mClockAccuracy));
 		waitingForACK = true;
 
@@ -888,7 +888,7 @@ void BaselineBANMac::sendPacket() {
 		 * For this reason we are waiting for 2*pTIFS just to be on the safe side. We do not account
 		 * for the clock drift, since this should be really small for just a packet transmission.
 		 */
-		trace() << "TXing[" << packetToBeSent->getName() << "], no ACK required";
+		TRACE << "TXing[" << packetToBeSent->getName() << "], no ACK required";
 		setTimer(START_ATTEMPT_TX, SLEEP2TX + TX_TIME(packetToBeSent->getByteLength()) + 2*pTIFS);
 		futureAttemptToTX = true;
 
@@ -906,7 +906,7 @@ void BaselineBANMac::handlePoll(BaselineMacPacket *pkt) {
 	// check if this is an immediate (not future) poll
 	if (pkt->getMoreData() == 0){
 		macState = MAC_FREE_TX_ACCESS;
-		trace() << "State from "<< macState << " to MAC_FREE_TX_ACCESS (poll)";
+		TRACE << "State from "<< macState << " to MAC_FREE_TX_ACCESS (poll)";
 		isPollPeriod = true;
 		int endPolledAccessSlot = pkt->getSequenceNumber();
 		/* The end of the polled access time is given as the end of an allocation
@@ -923,7 +923,7 @@ void BaselineBANMac::handlePoll(BaselineMacPacket *pkt) {
 		}else cancelTimer(START_SLEEPING);
 
 		int currentSlotEstimate = round(SIMTIME_DBL(getClock()-frameStartTime)/allocationSlotLength)+1;
-		if (currentSlotEstimate-1 > beaconPeriodLength) trace() << "WARNING: currentSlotEstimate= "<< currentSlotEstimate;
+		if (currentSlotEstimate-1 > beaconPeriodLength) TRACE << "WARNING: currentSlotEstimate= "<< currentSlotEstimate;
 		collectOutput("var stats", "poll slots taken", (endPolledAccessSlot+1) - currentSlotEstimate );
 		attemptTX();
 	}
@@ -933,7 +933,7 @@ void BaselineBANMac::handlePoll(BaselineMacPacket *pkt) {
 		int postedAccessStart = pkt->getSequenceNumber();
 		postedAccessEnd = postedAccessStart + 1; // all posts last one slot, end here is the beginning of the end slot
 		simtime_t postTime = frameStartTime + (postedAccessStart-1 + pkt->getFragmentNumber()* beaconPeriodLength) * allocationSlotLength;
-		trace() << "Future Poll received, postSlot= "<< postedAccessStart <<" waking up in " << postTime - GUARD_TIME - getClock();
+		TRACE << "Future Poll received, postSlot= "<< postedAccessStart <<" waking up in " << postTime - GUARD_TIME - getClock();
 		// if the post is the slot immediately after, then we have to check if we get a negative number for the timer
 		if (postTime <= getClock() - GUARD_TIME) setTimer(START_POSTED_ACCESS, 0);
 		else setTimer(START_POSTED_ACCESS, postTime - GUARD_TIME - getClock());
@@ -970,7 +970,7 @@ void BaselineBANMac::handleMoreDataAtHub(BaselineMacPacket *pkt) {
 	 */
 	if (currentSlot == lastTxAccessSlot[NID].scheduled || currentSlot == lastTxAccessSlot[NID].polled){
 		if (nextFuturePollSlot <= beaconPeriodLength) {
-			trace() << "Hub handles more Data ("<< pkt->getMoreData() <<")from NID: "<< NID <<" current slot: " << currentSlot;
+			TRACE << "Hub handles more Data ("<< pkt->getMoreData() <<")from NID: "<< NID <<" current slot: " << currentSlot;
 			reqToSendMoreData[NID] = pkt->getMoreData();
 			// if an ack is required for the packet the poll will be sent as an I_ACK_POLL
 			if (pkt->getAckPolicy() == I_ACK_POLICY) sendIAckPoll = true;
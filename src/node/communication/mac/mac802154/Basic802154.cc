@@ -134,7 +134,7 @@ void Basic802154::timerFiredCallback(int index)
 				CAPend = CAPlength * baseSlotDuration * (1 << frameOrder) * symbolLen;
 				sentBeacons++;
 
-				trace() << "Transmitting [PAN beacon packet] now, BSN = " << macBSN;
+				TRACE << "Transmitting [PAN beacon packet] now, BSN = " << macBSN;
 				setMacState(MAC_STATE_CAP);
 				toRadioLayer(beaconPacket);
 				toRadioLayer(createRadioCommand(SET_STATE, TX));
@@ -173,14 +173,14 @@ void Basic802154::timerFiredCallback(int index)
 		case BEACON_TIMEOUT: {
 			lostBeacons++;
 			if (lostBeacons >= maxLostBeacons) {
-				trace() << "Lost synchronisation with PAN " << associatedPAN;
+				TRACE << "Lost synchronisation with PAN " << associatedPAN;
 				setMacState(MAC_STATE_SETUP);
 				associatedPAN = -1;
 				desyncTimeStart = getClock();
 				disconnectedFromPAN_node();
 				if (currentPacket) clearCurrentPacket("No PAN");
 			} else if (associatedPAN != -1) {
-				trace() << "Missed beacon from PAN " << associatedPAN <<
+				TRACE << "Missed beacon from PAN " << associatedPAN <<
 				    ", will wake up to receive next beacon in " <<
 				    beaconInterval * symbolLen - guardTime * 3 << " seconds";
 				setMacState(MAC_STATE_SLEEP);
@@ -232,7 +232,7 @@ void Basic802154::timerFiredCallback(int index)
 				setTimer(PERFORM_CCA, phyDelayForValidCS);
 			} else {	
 				//Clear Channel Assesment (CCA) pin is not valid at all (radio is sleeping?)
-				trace() << "ERROR: isChannelClear() called when radio is not ready";
+				TRACE << "ERROR: isChannelClear() called when radio is not ready";
 				toRadioLayer(createRadioCommand(SET_STATE, RX));
 			}
 			break;
@@ -301,7 +301,7 @@ void Basic802154::finishSpecific()
 		} else if (iter->first.find("NoPAN") != string::npos) {
 			collectOutput("Packet breakdown", "Failed, no PAN", iter->second);
 		} else {
-			trace() << "Unknown packet breakdonw category: " <<
+			TRACE << "Unknown packet breakdonw category: " <<
 				iter->first << " with " << iter->second << " packets";
 		}
 	}
@@ -328,7 +328,7 @@ void Basic802154::setMacState(int newState)
 	if (macState == newState)
 		return;
 	if (printStateTransitions)
-		trace() << "MAC state changed from " << stateDescr[macState] << " to " << stateDescr[newState];
+		TRACE << "MAC state changed from " << stateDescr[macState] << " to " << stateDescr[newState];
 	macState = newState;
 }
 
@@ -402,7 +402,7 @@ void Basic802154::fromRadioLayer(cPacket * pkt, double rssi, double lqi)
 					GTSend = GTSstart + rcvPacket->getGTSlist(i).length *
 					    baseSlotDuration * (1 << frameOrder) * symbolLen;
 					GTSlength = GTSend - GTSstart;
-					trace() << "GTS slot from " << getClock() + GTSstart << 
+					TRACE << "GTS slot from " << getClock() + GTSstart << 
 						" to " << getClock() + GTSend << " length " << GTSlength;
 				}
 			}
@@ -441,7 +441,7 @@ void Basic802154::fromRadioLayer(cPacket * pkt, double rssi, double lqi)
 				break;
 
 			if (associationRequest_hub(rcvPacket)) {
-				trace() << "Accepting association request from " << rcvPacket->getSrcID();
+				TRACE << "Accepting association request from " << rcvPacket->getSrcID();
 				// update associatedDevices and reply with an ACK
 				associatedDevices[rcvPacket->getSrcID()] = true;
 				Basic802154Packet *ackPacket = new Basic802154Packet("PAN associate response", MAC_LAYER_PACKET);
@@ -454,7 +454,7 @@ void Basic802154::fromRadioLayer(cPacket * pkt, double rssi, double lqi)
 				toRadioLayer(createRadioCommand(SET_STATE, TX));
 				setTimer(ATTEMPT_TX, TX_TIME(ACK_PKT_SIZE));
 			} else {
-				trace() << "Denied association request from " << rcvPacket->getSrcID();
+				TRACE << "Denied association request from " << rcvPacket->getSrcID();
 				// Need to send a packet to deny the reuqest. 
 				// But current implementation always accepts them
 			}
@@ -472,7 +472,7 @@ void Basic802154::fromRadioLayer(cPacket * pkt, double rssi, double lqi)
 			if (rcvPacket->getPANid() != SELF_MAC_ADDRESS)
 				break;
 				
-			trace() << "Received GTS request from " << rcvPacket->getSrcID();
+			TRACE << "Received GTS request from " << rcvPacket->getSrcID();
 			
 			// reply with an ACK
 			Basic802154Packet *ackPacket = new Basic802154Packet("PAN GTS response", MAC_LAYER_PACKET);
@@ -504,7 +504,7 @@ void Basic802154::fromRadioLayer(cPacket * pkt, double rssi, double lqi)
 				dataReceived_hub(rcvPacket);
 				toNetworkLayer(decapsulatePacket(rcvPacket));
 			} else {
-				trace() << "Packet [" << rcvPacket->getName() << "] from node " 
+				TRACE << "Packet [" << rcvPacket->getName() << "] from node " 
 						<< rcvPacket->getSrcID() << " is a duplicate";
 			}
 
@@ -528,7 +528,7 @@ void Basic802154::fromRadioLayer(cPacket * pkt, double rssi, double lqi)
 		}
 
 		default:{
-			trace() << "WARNING: unknown packet type received [" << rcvPacket->getName() << "]";
+			TRACE << "WARNING: unknown packet type received [" << rcvPacket->getName() << "]";
 		}
 	}
 }
@@ -536,7 +536,7 @@ void Basic802154::fromRadioLayer(cPacket * pkt, double rssi, double lqi)
 void Basic802154::handleAckPacket(Basic802154Packet * rcvPacket)
 {
 	if (currentPacket == NULL) {
-		trace() << "WARNING received ACK packet while currentPacket == NULL";
+		TRACE << "WARNING received ACK packet while currentPacket == NULL";
 		return;
 	}
 		
@@ -551,7 +551,7 @@ void Basic802154::handleAckPacket(Basic802154Packet * rcvPacket)
 				desyncTime += getClock() - desyncTimeStart;
 				desyncTimeStart = -1;
 			}
-			trace() << "Associated with PAN:" << associatedPAN;
+			TRACE << "Associated with PAN:" << associatedPAN;
 			setMacState(MAC_STATE_CAP);
 			clearCurrentPacket("Success",true);
 			connectedToPAN_node();
@@ -561,7 +561,7 @@ void Basic802154::handleAckPacket(Basic802154Packet * rcvPacket)
 		//received an ack while waiting for a response to data packet
 		case MAC_802154_DATA_PACKET: {
 			if (currentPacket->getSeqNum() == rcvPacket->getSeqNum()) {
-				trace() << "Data packet successfully transmitted to " << rcvPacket->getSrcID() 
+				TRACE << "Data packet successfully transmitted to " << rcvPacket->getSrcID() 
 						<< ", local clock " << getClock();
 				clearCurrentPacket("Success",true);
 			} else {
@@ -578,7 +578,7 @@ void Basic802154::handleAckPacket(Basic802154Packet * rcvPacket)
 		}
 
 		default:{
-			trace() << "WARNING: received unexpected ACK to packet [" << currentPacket->getName() << "]";
+			TRACE << "WARNING: received unexpected ACK to packet [" << currentPacket->getName() << "]";
 			break;
 		}
 	}
@@ -597,7 +597,7 @@ void Basic802154::clearCurrentPacket(const char * s, bool success) {
 		else
 			packetBreak["Broadcast"]++;
 	}
-	trace() << "Transmission outcome for [" << currentPacket->getName() << "]: " << currentPacketHistory;
+	TRACE << "Transmission outcome for [" << currentPacket->getName() << "]: " << currentPacketHistory;
 	
 	// transmissionOutcome callback below might request another transmission by
 	// calling transmitPacket(). Therefore, we save and clear the currentPacket 
@@ -617,7 +617,7 @@ void Basic802154::clearCurrentPacket(const char * s, bool success) {
 // 4) transmitPacket called again, replacing the old packet
 void Basic802154::transmitPacket(Basic802154Packet *pkt, int retries, bool state, double limit) {
 	clearCurrentPacket();
-	trace() << "transmitPacket([" << pkt->getName() << "]," << retries << "," << state << "," << limit << ")";
+	TRACE << "transmitPacket([" << pkt->getName() << "]," << retries << "," << state << "," << limit << ")";
 	currentPacket = pkt;
 	currentPacketGtsOnly = state;
 	currentPacketHistory = "";
@@ -639,7 +639,7 @@ void Basic802154::attemptTransmission(const char * descr)
 {
 	cancelTimer(ATTEMPT_TX);
 	if (macState == MAC_STATE_SLEEP || macState == MAC_STATE_SETUP) return;
-	trace() << "Attempt transmission, description: " << descr;
+	TRACE << "Attempt transmission, description: " << descr;
 	
 	// if a packet already queued for transmission - check avaliable retries and delay
 	if (currentPacket && (currentPacketRetries == 0 || (currentPacketLimit > 0 && 
@@ -650,19 +650,19 @@ void Basic802154::attemptTransmission(const char * descr)
 	
 	if (currentPacket) {
 		if (macState == MAC_STATE_GTS) {	
-			trace() << "Transmitting [" << currentPacket->getName() << "] in GTS";
+			TRACE << "Transmitting [" << currentPacket->getName() << "] in GTS";
 			transmitCurrentPacket();
 		} else if (macState == MAC_STATE_CAP && currentPacketGtsOnly == false) {
-			trace() << "Transmitting [" << currentPacket->getName() << "] in CAP, starting CSMA_CA";
+			TRACE << "Transmitting [" << currentPacket->getName() << "] in CAP, starting CSMA_CA";
 			NB = 0;
 			CW = enableSlottedCSMA ? 2 : 1;
 			BE = batteryLifeExtention ? (macMinBE < 2 ? macMinBE : 2) : macMinBE;
 			performCSMACA();	
 		} else {
-			trace() << "Skipping transmission attempt in CAP due to GTSonly flag";
+			TRACE << "Skipping transmission attempt in CAP due to GTSonly flag";
 		}
 	} else {
-		trace() << "Nothing to transmit";
+		TRACE << "Nothing to transmit";
 	}
 }
 
@@ -680,7 +680,7 @@ void Basic802154::performCSMACA()
 		CCAtime += backoffBoundary;
 	}
 
-	trace() << "CSMA/CA random backoff value: " << rnd << ", in " << CCAtime << " seconds";
+	TRACE << "CSMA/CA random backoff value: " << rnd << ", in " << CCAtime << " seconds";
 
 	//set a timer to perform carrier sense after calculated time
 	setTimer(PERFORM_CCA, CCAtime);
@@ -690,7 +690,7 @@ void Basic802154::performCSMACA()
 void Basic802154::transmitCurrentPacket()
 {
 	if (currentPacket == NULL) {
-		trace() << "WARNING: transmitCurrentPacket() called while currentPacket == NULL";
+		TRACE << "WARNING: transmitCurrentPacket() called while currentPacket == NULL";
 		return;
 	}
 	
@@ -716,16 +716,16 @@ void Basic802154::transmitCurrentPacket()
 		}
 		//decrement retry counter, set transmission end timer and modify mac and radio states.
 		currentPacketRetries--;
-		trace() << "Transmitting [" << currentPacket->getName() << "] now, remaining attempts " 
+		TRACE << "Transmitting [" << currentPacket->getName() << "] now, remaining attempts " 
 				<< currentPacketRetries;
 		setTimer(currentPacketResponse > 0 ? ACK_TIMEOUT : ATTEMPT_TX, txTime);
 		toRadioLayer(currentPacket->dup());
 		toRadioLayer(createRadioCommand(SET_STATE, TX));
 	} else {
 		//transmission not allowed
-		trace() << "txTime " << txTime << " CAP:" << (currentFrameStart + CAPend - getClock()) << 
+		TRACE << "txTime " << txTime << " CAP:" << (currentFrameStart + CAPend - getClock()) << 
 				" GTS:" << (currentFrameStart + GTSend - getClock());
-		trace() << "Transmission of [" << currentPacket->getName() << "] stopped, not enough time";
+		TRACE << "Transmission of [" << currentPacket->getName() << "] stopped, not enough time";
 	}
 }
 
@@ -734,7 +734,7 @@ void Basic802154::transmitCurrentPacket()
 void Basic802154::collectPacketHistory(const char *s)
 {
 	if (!currentPacket) {
-		trace() << "WARNING: collectPacketState called while currentPacket==NULL, string:"<<s;
+		TRACE << "WARNING: collectPacketState called while currentPacket==NULL, string:"<<s;
 		return;
 	}
 	if (currentPacketHistory.size()) {
@@ -62,7 +62,7 @@ int StaticGTS802154::gtsRequest_hub(Basic802154Packet *gtsPkt) {
 	//node not found, or requested slots changed
 	if (total >= 7 || (CAPlength - gtsPkt->getGTSlength()) *
 	    baseSlot * (1 << frameOrder) < minCap) {
-		trace() << "GTS request from " << gtsPkt->getSrcID() <<
+		TRACE << "GTS request from " << gtsPkt->getSrcID() <<
 		    " cannot be acocmodated";
 		return 0;
 	}
@@ -88,7 +88,7 @@ void StaticGTS802154::prepareBeacon_hub(Basic802154Packet *beaconPacket) {
 			GTSlist[i].start = CAPlength + 1;
 			beaconPacket->setGTSlist(i, GTSlist[i]);
 		} else {
-			trace() << "Internal ERROR: GTS list corrupted";
+			TRACE << "Internal ERROR: GTS list corrupted";
 			GTSlist.clear(); totalGTS = 0;
 			beaconPacket->setGTSlistArraySize(0);	
 			CAPlength = totalSlots;
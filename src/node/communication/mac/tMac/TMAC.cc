@@ -36,7 +36,7 @@ void TMAC::startup()
 	conservativeTA = par("conservativeTA");
 	collisionResolution = par("collisionResolution");
 	if (collisionResolution != 2 && collisionResolution != 1 && collisionResolution != 0) {
-		trace() << "Unknown value for parameter 'collisionResolution', will default to 1";
+		TRACE << "Unknown value for parameter 'collisionResolution', will default to 1";
 		collisionResolution = 1;
 	}
 	//Initialise state descriptions used in debug output
@@ -118,7 +118,7 @@ void TMAC::timerFiredCallback(int timer)
 			 * It is required to rebroadcast a SYNC packet and also
 			 * schedule a self message for the next RESYNC procedure.
 			 */
-			trace() << "Initiated RESYNC procedure";
+			TRACE << "Initiated RESYNC procedure";
 			scheduleTable[0].SN++;
 			needResync = 1;
 			setTimer(SYNC_RENEW, resyncTime);
@@ -141,7 +141,7 @@ void TMAC::timerFiredCallback(int timer)
 			// clock drift - in this case it is necessary to rebroadcast this resync further)
 			setTimer(FRAME_START, frameTime);
 			if (scheduleTable[0].offset != 0) {
-				trace() << "New frame started, shifted by " << scheduleTable[0].offset;
+				TRACE << "New frame started, shifted by " << scheduleTable[0].offset;
 				scheduleTable[0].offset = 0;
 				needResync = 1;
 			}
@@ -211,7 +211,7 @@ void TMAC::timerFiredCallback(int timer)
 					&& macState != MAC_CARRIER_SENSE_FOR_TX_SYNC
 					&& macState != MAC_CARRIER_SENSE_FOR_TX_DATA
 					&& macState != MAC_CARRIER_SENSE_BEFORE_SLEEP) {
-				trace() << "WARNING: bad MAC state for MAC_SELF_PERFORM_CARRIER_SENSE";
+				TRACE << "WARNING: bad MAC state for MAC_SELF_PERFORM_CARRIER_SENSE";
 				break;
 			}
 
@@ -273,7 +273,7 @@ void TMAC::timerFiredCallback(int timer)
 					resetDefaultState("secondary schedule starts");
 				}
 			} else {
-				trace() << "Unknown timer " << timer;
+				TRACE << "Unknown timer " << timer;
 			}
 		}
 	}
@@ -316,7 +316,7 @@ void TMAC::fromNetworkLayer(cPacket * netPkt, int destination)
 void TMAC::resetDefaultState(const char *descr)
 {
 	if (descr)
-		trace() << "Resetting MAC state to default, reason: " << descr;
+		TRACE << "Resetting MAC state to default, reason: " << descr;
 
 	if (activationTimeout <= getClock()) {
 		if (disableTAextension) {
@@ -344,7 +344,7 @@ void TMAC::resetDefaultState(const char *descr)
 
 		while (!TXBuffer.empty()) {
 			if (txRetries <= 0) {
-				trace() << "Transmission failed to " << txAddr;
+				TRACE << "Transmission failed to " << txAddr;
 				popTxBuffer();
 			} else {
 				if (useRtsCts && txAddr != BROADCAST_MAC_ADDRESS) {
@@ -380,10 +380,10 @@ void TMAC::setMacState(int newState, const char *descr)
 		return;
 	if (printStateTransitions) {
 		if (descr)
-			trace() << "state changed from " << stateDescr[macState] <<
+			TRACE << "state changed from " << stateDescr[macState] <<
 					" to " << stateDescr[newState] << ", reason: " << descr;
 		else
-			trace() << "state changed from " << stateDescr[macState] <<
+			TRACE << "state changed from " << stateDescr[macState] <<
 					" to " << stateDescr[newState];
 	}
 	macState = newState;
@@ -403,7 +403,7 @@ void TMAC::updateScheduleTable(simtime_t wakeup, int ID, int SN)
 
 				//Calculate new frame offset for this schedule
 				simtime_t new_offset = getClock() - currentFrameStart + wakeup - frameTime;
-				trace() << "Resync successful for ID:" << ID << " old offset:" <<
+				TRACE << "Resync successful for ID:" << ID << " old offset:" <<
 						scheduleTable[i].offset << " new offset:" << new_offset;
 				scheduleTable[i].offset = new_offset;
 				scheduleTable[i].SN = SN;
@@ -437,7 +437,7 @@ void TMAC::updateScheduleTable(simtime_t wakeup, int ID, int SN)
 	TMacSchedule newSch;
 	newSch.ID = ID;
 	newSch.SN = SN;
-	trace() << "Creating schedule ID:" << ID << ", SN:" << SN << ", wakeup:" << wakeup;
+	TRACE << "Creating schedule ID:" << ID << ", SN:" << SN << ", wakeup:" << wakeup;
 
 	//Calculate the offset for the new schedule
 	if (currentFrameStart == -1) {
@@ -533,13 +533,13 @@ void TMAC::fromRadioLayer(cPacket * pkt, double RSSI, double LQI)
 		case CTS_TMAC_PACKET:{
 			if (macState == MAC_STATE_WAIT_FOR_CTS) {
 				if (TXBuffer.empty()) {
-					trace() << "WARNING: invalid MAC_STATE_WAIT_FOR_CTS while buffer is empty";
+					TRACE << "WARNING: invalid MAC_STATE_WAIT_FOR_CTS while buffer is empty";
 					resetDefaultState("invalid state while buffer is empty");
 				} else if (source == txAddr) {
 					cancelTimer(TRANSMISSION_TIMEOUT);
 					sendDataPacket();
 				} else {
-					trace() << "WARNING: recieved unexpected CTS from " << source;
+					TRACE << "WARNING: recieved unexpected CTS from " << source;
 					resetDefaultState("unexpected CTS");
 				}
 			}
@@ -590,7 +590,7 @@ void TMAC::fromRadioLayer(cPacket * pkt, double RSSI, double LQI)
 		/* received ACK frame */
 		case ACK_TMAC_PACKET:{
 			if (macState == MAC_STATE_WAIT_FOR_ACK && source == txAddr) {
-				trace() << "Transmission succesful to " << txAddr;
+				TRACE << "Transmission succesful to " << txAddr;
 				cancelTimer(TRANSMISSION_TIMEOUT);
 				popTxBuffer();
 				resetDefaultState("transmission successful (ACK received)");
@@ -608,7 +608,7 @@ void TMAC::fromRadioLayer(cPacket * pkt, double RSSI, double LQI)
 		}
 
 		default:{
-			trace() << "Packet with unknown type (" << macPkt->getType() <<
+			TRACE << "Packet with unknown type (" << macPkt->getType() <<
 					") received: [" << macPkt->getName() << "]";
 		}
 	}
@@ -650,7 +650,7 @@ void TMAC::carrierIsClear()
 		/* MAC requested carrier sense to transmit an RTS packet */
 		case MAC_CARRIER_SENSE_FOR_TX_RTS:{
 			if (TXBuffer.empty()) {
-				trace() << "WARNING! BUFFER_IS_EMPTY in MAC_CARRIER_SENSE_FOR_TX_RTS, will reset state";
+				TRACE << "WARNING! BUFFER_IS_EMPTY in MAC_CARRIER_SENSE_FOR_TX_RTS, will reset state";
 				resetDefaultState("empty transmission buffer");
 				break;
 			}
@@ -702,7 +702,7 @@ void TMAC::carrierIsClear()
 				setTimer(TRANSMISSION_TIMEOUT, TX_TIME(syncPacketSize));
 
 			} else {
-				trace() << "WARNING: Invalid MAC_CARRIER_SENSE_FOR_TX_SYNC while syncPacket undefined";
+				TRACE << "WARNING: Invalid MAC_CARRIER_SENSE_FOR_TX_SYNC while syncPacket undefined";
 				resetDefaultState("invalid state, no SYNC packet found");
 			}
 			break;
@@ -731,7 +731,7 @@ void TMAC::carrierIsClear()
 void TMAC::sendDataPacket()
 {
 	if (TXBuffer.empty()) {
-		trace() << "WARNING: Invalid MAC_CARRIER_SENSE_FOR_TX_DATA while TX buffer is empty";
+		TRACE << "WARNING: Invalid MAC_CARRIER_SENSE_FOR_TX_DATA while TX buffer is empty";
 		resetDefaultState("empty transmission buffer");
 		return;
 	}
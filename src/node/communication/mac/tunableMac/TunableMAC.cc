@@ -39,7 +39,7 @@ void TunableMAC::startup()
 			if ((dutyCycle > 0.0) && (dutyCycle < 1.0))
 				backoffType = BACKOFF_SLEEP_INT;
 			else
-				trace() << "Illegal value of parameter \"backoffType\" in omnetpp.ini.\n    Backoff timer = sleeping interval, but sleeping interval is not defined because duty cycle is zero, one, or invalid. Will use backOffBaseValue instead";
+				TRACE << "Illegal value of parameter \"backoffType\" in omnetpp.ini.\n    Backoff timer = sleeping interval, but sleeping interval is not defined because duty cycle is zero, one, or invalid. Will use backOffBaseValue instead";
 			backoffType = BACKOFF_CONSTANT;
 			break;
 		}
@@ -112,7 +112,7 @@ void TunableMAC::timerFiredCallback(int timer)
 		}
 
 		default:{
-			trace() << "WARNING: unknown timer callback " << timer;
+			TRACE << "WARNING: unknown timer callback " << timer;
 		}
 	}
 }
@@ -145,7 +145,7 @@ void TunableMAC::handleCarrierSenseResult(int returnCode)
 			}
 
 			macState = MAC_STATE_TX;
-			trace() << "Channel Clear, MAC_STATE_TX, sending " << remainingBeaconsToTx << " beacons followed by data";
+			TRACE << "Channel Clear, MAC_STATE_TX, sending " << remainingBeaconsToTx << " beacons followed by data";
 			sendBeaconsOrData();
 			break;
 
@@ -165,7 +165,7 @@ void TunableMAC::handleCarrierSenseResult(int returnCode)
 			 */
 			if (CSMApersistance > 0) {
 				setTimer(START_CARRIER_SENSING, phyDelayForValidCS);
-				trace() << "Channel busy, persistent mode: checking again in " << phyDelayForValidCS << " secs";
+				TRACE << "Channel busy, persistent mode: checking again in " << phyDelayForValidCS << " secs";
 				break;
 			}
 
@@ -200,7 +200,7 @@ void TunableMAC::handleCarrierSenseResult(int returnCode)
 
 			backoffTimer = genk_dblrand(1) * backoffTimer;
 			setTimer(START_CARRIER_SENSING, backoffTimer);
-			trace() << "Channel busy, backing off for " << backoffTimer << " secs";
+			TRACE << "Channel busy, backing off for " << backoffTimer << " secs";
 
 			/* If having a dutyCycle or relevant parameter is enabled
 			 * go directly to sleep. One could say "wait for listenInterval
@@ -219,7 +219,7 @@ void TunableMAC::handleCarrierSenseResult(int returnCode)
 		case CS_NOT_VALID:
 		case CS_NOT_VALID_YET:{
 			setTimer(START_CARRIER_SENSING, phyDelayForValidCS);
-			trace() << "CS not valid yet, trying again.";
+			TRACE << "CS not valid yet, trying again.";
 			break;
 		}
 	}
@@ -260,13 +260,13 @@ void TunableMAC::fromNetworkLayer(cPacket * netPkt, int destination)
 		 * FULL_BUFFER control msg sent by virtualMAC code
 		 */
 		collectOutput("TunableMAC packet breakdown", "Overflown");
-		trace() << "WARNING Tunable MAC buffer overflow";
+		TRACE << "WARNING Tunable MAC buffer overflow";
 	}
 }
 
 void TunableMAC::attemptTx()
 {
-	trace() << "attemptTx(), buffer size: " << TXBuffer.size() << ", numTxTries: " << numTxTries;
+	TRACE << "attemptTx(), buffer size: " << TXBuffer.size() << ", numTxTries: " << numTxTries;
 
 	if (numTxTries <= 0) {
 		/* We can enter attemptTx from many places, in some cases
@@ -287,7 +287,7 @@ void TunableMAC::attemptTx()
 			attemptTx();
 		} else {
 			macState = MAC_STATE_DEFAULT;
-			trace() << "MAC_STATE_DEFAULT, no more pkts to attemptTx";
+			TRACE << "MAC_STATE_DEFAULT, no more pkts to attemptTx";
 			/* We have nothing left to transmit, need to resume
 			 * sleep/listen pattern. Starting by going to sleep
 			 * immediately (timer with 0 delay).
@@ -303,11 +303,11 @@ void TunableMAC::attemptTx()
 	if (genk_dblrand(0) < probTx) {
 		// This transmission attempt will happen after random offset
 		setTimer(START_CARRIER_SENSING, genk_dblrand(1) * randomTxOffset);
-		trace() << "MAC_STATE_CONTENDING, attempt " << numTx - numTxTries +1 << "/" << numTx << " contending";
+		TRACE << "MAC_STATE_CONTENDING, attempt " << numTx - numTxTries +1 << "/" << numTx << " contending";
 	} else {
 		// Move on to the next attempt after reTxInterval
 		setTimer(ATTEMPT_TX, reTxInterval);
-		trace() << "MAC_STATE_CONTENDING, attempt " << numTx - numTxTries +1 << "/" << numTx << " skipped";
+		TRACE << "MAC_STATE_CONTENDING, attempt " << numTx - numTxTries +1 << "/" << numTx << " skipped";
 		numTxTries--;
 	}
 }
@@ -326,7 +326,7 @@ void TunableMAC::sendBeaconsOrData()
 		beaconFrame->setByteLength(beaconFrameSize);
 		toRadioLayer(beaconFrame);
 		toRadioLayer(createRadioCommand(SET_STATE, TX));
-		trace() << "Sending Beacon";
+		TRACE << "Sending Beacon";
 		collectOutput("TunableMAC packet breakdown", "sent beacons");
 
 		/* Set timer to send next beacon (or data packet). Schedule
@@ -348,11 +348,11 @@ void TunableMAC::sendBeaconsOrData()
 
 		// Record whether this was an original transmission or a retransmission
 		if (numTxTries == numTx){
-			trace() << "Sending data packet";
+			TRACE << "Sending data packet";
 			collectOutput("TunableMAC packet breakdown", "sent data pkts");
 		}
 		else{
-			trace() << "Sending copy of data packet";
+			TRACE << "Sending copy of data packet";
 			collectOutput("TunableMAC packet breakdown", "copies of sent data pkts");
 		}
 
@@ -430,16 +430,16 @@ void TunableMAC::fromRadioLayer(cPacket * pkt, double rssi, double lqi)
 				/* We ignore the received beacon packet because we
 				 * are in the process of sending our own data
 				 */
-				trace() << "ignoring beacon, we are in MAC_STATE_TX"; 
+				TRACE << "ignoring beacon, we are in MAC_STATE_TX"; 
 				collectOutput("TunableMAC packet breakdown", "received beacons, ignored");
 				break;
 			}
 			macState = MAC_STATE_RX;
-			trace() << "MAC_STATE_RX, received beacon";
+			TRACE << "MAC_STATE_RX, received beacon";
 			if ((dutyCycle > 0.0) && (dutyCycle < 1.0)) {
 				setTimer(ATTEMPT_TX, sleepInterval);
 			} else {
-				trace() << "WARNING: received a beacon packet without duty cycle in place";
+				TRACE << "WARNING: received a beacon packet without duty cycle in place";
 				/* This happens only when one node has duty cycle while
 				 * another one does not. TunableMac was not designed for
 				 * this case as more thought is required a possible
@@ -463,7 +463,7 @@ void TunableMAC::fromRadioLayer(cPacket * pkt, double rssi, double lqi)
 			break;
 		}
 		default:{
-			trace() << "WARNING: Received packet type UNKNOWN";
+			TRACE << "WARNING: Received packet type UNKNOWN";
 			collectOutput("TunableMAC packet breakdown", "unrecognized type");
 		}
 	}
@@ -514,7 +514,7 @@ int TunableMAC::handleControlCommand(cMessage * msg)
 
 			double tmpValue = cmd->getParameter() / 1000.0;
 			if (tmpValue < 0.0)
-				trace() << "WARNING: invalid listen interval value sent to TunableMac";
+				TRACE << "WARNING: invalid listen interval value sent to TunableMac";
 			else {
 				listenInterval = tmpValue;
 				if ((dutyCycle > 0.0) && (dutyCycle < 1.0))
@@ -529,7 +529,7 @@ int TunableMAC::handleControlCommand(cMessage * msg)
 
 			double tmpValue = cmd->getParameter();
 			if ((tmpValue < 0.0) || (tmpValue > 1.0))
-				trace() << "WARNING: invalid Beacon Interval Fraction value sent to TunableMac";
+				TRACE << "WARNING: invalid Beacon Interval Fraction value sent to TunableMac";
 			else
 				beaconIntervalFraction = tmpValue;
 			break;
@@ -539,7 +539,7 @@ int TunableMAC::handleControlCommand(cMessage * msg)
 
 			double tmpValue = cmd->getParameter();
 			if ((tmpValue < 0.0) || (tmpValue > 1.0))
-				trace() << "WARNING: invalid ProbTX value sent to TunableMac";
+				TRACE << "WARNING: invalid ProbTX value sent to TunableMac";
 			else
 				probTx = tmpValue;
 			break;
@@ -549,7 +549,7 @@ int TunableMAC::handleControlCommand(cMessage * msg)
 
 			double tmpValue = cmd->getParameter();
 			if (tmpValue < 0 || tmpValue - ceil(tmpValue) != 0)
-				trace() << "WARNING: invalid NumTX value sent to TunableMac";
+				TRACE << "WARNING: invalid NumTX value sent to TunableMac";
 			else
 				numTx = (int)tmpValue;
 			break;
@@ -559,7 +559,7 @@ int TunableMAC::handleControlCommand(cMessage * msg)
 
 			double tmpValue = cmd->getParameter() / 1000.0;
 			if (tmpValue <= 0.0)
-				trace() << "WARNING: invalid randomTxOffset value sent to TunableMac";
+				TRACE << "WARNING: invalid randomTxOffset value sent to TunableMac";
 			else
 				randomTxOffset = tmpValue;
 			break;
@@ -569,7 +569,7 @@ int TunableMAC::handleControlCommand(cMessage * msg)
 
 			double tmpValue = cmd->getParameter() / 1000.0;
 			if (tmpValue <= 0.0)
-				trace() << "WARNING: invalid reTxInterval value sent to TunableMac";
+				TRACE << "WARNING: invalid reTxInterval value sent to TunableMac";
 			else
 				reTxInterval = tmpValue;
 			break;
@@ -583,32 +583,32 @@ int TunableMAC::handleControlCommand(cMessage * msg)
 				if ((dutyCycle > 0.0) && (dutyCycle < 1.0))
 					backoffType = BACKOFF_SLEEP_INT;
 				else
-					trace() << "WARNING: invalid backoffType value sent to TunableMac. Backoff timer = sleeping interval, but sleeping interval is not defined because duty cycle is zero, one, or invalid.";
+					TRACE << "WARNING: invalid backoffType value sent to TunableMac. Backoff timer = sleeping interval, but sleeping interval is not defined because duty cycle is zero, one, or invalid.";
 			}
 
 			else if (tmpValue == 1.0) {
 				if (backoffBaseValue <= 0.0)
-					trace() << "WARNING: unable to set backoffType. Parameter backoffBaseValue has conflicting value";
+					TRACE << "WARNING: unable to set backoffType. Parameter backoffBaseValue has conflicting value";
 				else
 					backoffType = BACKOFF_CONSTANT;
 			}
 
 			else if (tmpValue == 2.0) {
 				if (backoffBaseValue <= 0.0)
-					trace() << "WARNING: unable to set backoffType. Parameter backoffBaseValue has conflicting value";
+					TRACE << "WARNING: unable to set backoffType. Parameter backoffBaseValue has conflicting value";
 				else
 					backoffType = BACKOFF_MULTIPLYING;
 			}
 
 			else if (tmpValue == 3.0) {
 				if (backoffBaseValue <= 0.0)
-					trace() << "WARNING: unable to set backoffType. Parameter backoffBaseValue has conflicting value";
+					TRACE << "WARNING: unable to set backoffType. Parameter backoffBaseValue has conflicting value";
 				else
 					backoffType = BACKOFF_EXPONENTIAL;
 			}
 
 			else
-				trace() << "WARNING: invalid backoffType value sent to TunableMac";
+				TRACE << "WARNING: invalid backoffType value sent to TunableMac";
 
 			break;
 		}
@@ -617,7 +617,7 @@ int TunableMAC::handleControlCommand(cMessage * msg)
 
 			double tmpValue = cmd->getParameter() / 1000.0;
 			if (tmpValue < 0)
-				trace() << "WARNING: invalid backoffBaseValue sent to TunableMac";
+				TRACE << "WARNING: invalid backoffBaseValue sent to TunableMac";
 			else
 				backoffBaseValue = tmpValue;
 			break;
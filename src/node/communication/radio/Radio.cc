@@ -11,6 +11,7 @@
  ****************************************************************************/
 
 #include "Radio.h"
+#include "WirelessChannel.h"
 
 Define_Module(Radio);
 
@@ -18,15 +19,26 @@ void Radio::initialize()
 {
 	// self can be used as a full MAC address
 	self = getParentModule()->getParentModule()->getIndex();
+	// the noise floor reads the weak interference from the channel, look it up
+	// before the initial state transition
+	wirelessChannelModule = dynamic_cast<WirelessChannel*>
+		(getParentModule()->getParentModule()->getParentModule()->getSubmodule("wirelessChannel"));
+
+	// the initial state transition may already schedule these
+	CSinterruptMsg = NULL;
+	capturedSignalID = -1;
+	stateTransitionMsg = new cMessage("Complete state transition", RADIO_ENTER_STATE);
+	continueTxMsg = new cMessage("continueTX", RADIO_CONTINUE_TX);
+	leaveTxCommand = new RadioControlCommand("Leave TX", RADIO_CONTROL_COMMAND);
+	leaveTxCommand->setRadioControlCommandKind(SET_STATE);
+	stateAfterTX = RX;
+
 	readIniFileParameters();
 	disabled = true;
 
 	rssiIntegrationTime = symbolsForRSSI * RXmode->bitsPerSymbol / RXmode->datarate;
-
-	CSinterruptMsg = NULL;
-	stateTransitionMsg = NULL;
-	latestCSinterruptTime = 0;
-	stateAfterTX = RX;
+	// the RSSI history of the starting state needs the integration time
+	completeStateTransition();	// this will complete initialisation of the radio according to startingState parameter
 
 	declareOutput("RX pkt breakdown");
 	declareOutput("TXed pkts");
@@ -37,6 +49,11 @@ void Radio::handleMessage(cMessage * msg)
 {
 
 	if (disabled && msg->getKind() != NODE_STARTUP) {
+		// our reusable self messages are kept, everything else is deleted
+		if (msg == stateTransitionMsg || msg == continueTxMsg || msg == leaveTxCommand)
+			return;
+		if (msg == CSinterruptMsg)
+			CSinterruptMsg = NULL;
 		delete msg;
 		return;
 	}
@@ -45,11 +62,9 @@ void Radio::handleMessage(cMessage * msg)
 
 		case NODE_STARTUP:{
 			disabled = false;
+			registerCarrierFreq();
 			timeOfLastSignalChange = simTime();
-			TotalPowerReceived_type initialTotalPower;
-			initialTotalPower.power_dBm = RXmode->noiseFloor;
-			initialTotalPower.startTime = simTime();
-			totalPowerReceived.push_front(initialTotalPower);
+			totalPowerReceived.add(currentNoiseFloor(), simTime(), rssiIntegrationTime);
 			break;
 		}
 
@@ -59,16 +74,23 @@ void Radio::handleMessage(cMessage * msg)
 		case WC_SIGNAL_START:{
 
 			WirelessChannelSignalBegin *wcMsg = check_and_cast<WirelessChannelSignalBegin*>(msg);
-			trace() << "START signal from node " << wcMsg->getNodeID() << " , received power " << wcMsg->getPower_dBm() << "dBm" ;
+			TRACE << "START signal from node " << wcMsg->getNodeID() << " , received power " << wcMsg->getPower_dBm() << "dBm" ;
 
-			/* If the carrier frequency does not match, it is as if we are not receiving it.
-			 * In the future, depending on carrierFreq and bandwidth, we can decide to include
-			 * the signal in the received signals list with reduced (spill over) power
+			/* If the carrier frequency does not match, the signal is attenuated according
+			 * to the adjacent channel rejection mask and can only act as interference.
+			 * Beyond the mask it is as if we are not receiving it. The wireless channel
+			 * normally does not even deliver such signals to us.
 			 */
-			if (wcMsg->getCarrierFreq() != carrierFreq){
-				trace() << "START signal ignored, different carrier freq";
+			double freqOffset = fabs(wcMsg->getCarrierFreq() - carrierFreq);
+			double rejection = channelRejection(freqOffset);
+			if (rejection < 0) {
+				TRACE << "START signal ignored, different carrier freq";
 				break;
 			}
+			if (rejection > 0) {
+				wcMsg->setPower_dBm(wcMsg->getPower_dBm() - rejection);
+				TRACE << "START signal on adjacent channel, " << rejection << "dB rejection";
+			}
 
 			/* if we are not in RX state or we are changing state, then process the
 			 * signal minimally. We still need to keep a list of signals because when
@@ -80,26 +102,28 @@ void Radio::handleMessage(cMessage * msg)
 				newSignal.ID = wcMsg->getNodeID();
 				newSignal.power_dBm = wcMsg->getPower_dBm();
 				newSignal.bitErrors = ALL_ERRORS;
-				receivedSignals.push_front(newSignal);
-				stats.RxFailedNoRxState++;
-				trace() << "Failed packet (WC_SIGNAL_START) from node " << newSignal.ID << ", radio not in RX state";
+				newSignal.numOfFrames = wcMsg->getNumOfFrames();
+				newSignal.firstSegment = newSignal.lastSegment = -1;
+				receivedSignals.add(newSignal);
+				if (freqOffset == 0) {
+					stats.RxFailedNoRxState += newSignal.numOfFrames;
+					TRACE << "Failed packet (WC_SIGNAL_START) from node " << newSignal.ID << ", radio not in RX state";
+				}
 				break;	// exit case WC_SIGNAL_START
 			}
 
 			/* If we are in RX state, go throught the list of received signals and update
 			 * bitErrors and currentInterference
 			 */
-			list<ReceivedSignal_type>::iterator it1;
+			ReceivedSignalSet::iterator it1;
 			for (it1 = receivedSignals.begin(); it1 != receivedSignals.end(); it1++) {
 
 				// no need to update bitErrors for an element which will not be received
 				if (it1->bitErrors == ALL_ERRORS || it1->bitErrors > maxErrorsAllowed(it1->encoding))
 					continue;
 
-				// calculate bit errors for the last segment of unchanged signal conditions
-				int numOfBits = (int)ceil(RXmode->datarate * SIMTIME_DBL(simTime() - timeOfLastSignalChange));
-				double BER = SNR2BER(it1->power_dBm - it1->currentInterference);
-				it1->bitErrors += bitErrors(BER, numOfBits, maxErrorsAllowed(it1->encoding) - it1->bitErrors);
+				// account for the last segment of unchanged signal conditions
+				updateBitErrors(it1);
 
 				// update currentInterference in the received signal structure (*it)
 				updateInterference(it1, wcMsg);
@@ -111,11 +135,14 @@ void Radio::handleMessage(cMessage * msg)
 			newSignal.power_dBm = wcMsg->getPower_dBm();
 			newSignal.modulation = (Modulation_type) wcMsg->getModulationType();
 			newSignal.encoding = (Encoding_type) wcMsg->getEncodingType();
+			newSignal.numOfFrames = wcMsg->getNumOfFrames();
+			newSignal.firstSegment = newSignal.lastSegment = -1;
 
 			switch (collisionModel) {
 
 				case ADDITIVE_INTERFERENCE_MODEL:	// the default mode
-					newSignal.currentInterference = totalPowerReceived.front().power_dBm;
+				case COMPLEX_INTERFERENCE_MODEL:
+					newSignal.currentInterference = addNoiseFloor_dBm(receivedSignals.totalPower_mW());
 					break;
 
 				case NO_INTERFERENCE_NO_COLLISIONS:
@@ -125,39 +152,39 @@ void Radio::handleMessage(cMessage * msg)
 				case SIMPLE_COLLISION_MODEL:
 					// if other received signals are larger than the noise floor
 					// then this is considered catastrophic interference.
-					if (totalPowerReceived.front().power_dBm > RXmode->noiseFloor)
+					if (totalPowerReceived.latest().power_dBm > RXmode->noiseFloor)
 						newSignal.currentInterference = 0.0; // this is a large value in dBm
 					else
 						newSignal.currentInterference = RXmode->noiseFloor;
 					break;
-
-				case COMPLEX_INTERFERENCE_MODEL:	// not implemented yet
-					newSignal.currentInterference = RXmode->noiseFloor;
-					break;
 			}
 
 			newSignal.maxInterference = newSignal.currentInterference;
-			if ((RXmode->modulation == newSignal.modulation) && (newSignal.power_dBm >= RXmode->sensitivity))
+			if (freqOffset > 0)
+				// signals from adjacent channels are only interference, not packets for us
+				newSignal.bitErrors = ALL_ERRORS;
+			else if ((RXmode->modulation == newSignal.modulation) && (newSignal.power_dBm >= RXmode->sensitivity))
 				newSignal.bitErrors = 0;
 			else {
 				// ALL_ERRORS signals are kept only for interference and RSSI calculations
 				newSignal.bitErrors = ALL_ERRORS;
 				// collect stats
 				if (newSignal.power_dBm < RXmode->sensitivity) {
-					stats.RxFailedSensitivity++;
-					trace() << "Failed packet (WC_SIGNAL_START) from node " << newSignal.ID << ", below sensitivity";
+					stats.RxFailedSensitivity += newSignal.numOfFrames;
+					TRACE << "Failed packet (WC_SIGNAL_START) from node " << newSignal.ID << ", below sensitivity";
 				}
 				else {
-					stats.RxFailedModulation++;
-					trace() << "Failed packet (WC_SIGNAL_START) from node " << newSignal.ID << ", wrong modulation";
+					stats.RxFailedModulation += newSignal.numOfFrames;
+					TRACE << "Failed packet (WC_SIGNAL_START) from node " << newSignal.ID << ", wrong modulation";
 				}
 			}
 
-			receivedSignals.push_front(newSignal);
-			updateTotalPowerReceived(newSignal.power_dBm);
+			if (collisionModel == COMPLEX_INTERFERENCE_MODEL && newSignal.bitErrors != ALL_ERRORS)
+				captureSignal(newSignal);
 
-			if ((carrierSenseInterruptEnabled) && (newSignal.power_dBm > CCAthreshold))
-				updatePossibleCSinterrupt();
+			receivedSignals.add(newSignal);
+			updateTotalPowerReceived(newSignal.power_dBm);
+			updatePossibleCSinterrupt();
 
 			timeOfLastSignalChange = simTime();
 
@@ -171,31 +198,30 @@ void Radio::handleMessage(cMessage * msg)
 
 			WirelessChannelSignalEnd *wcMsg = check_and_cast<WirelessChannelSignalEnd*>(msg);
 			int signalID = wcMsg->getNodeID();
-			trace() << "END signal from node " << signalID;
+			TRACE << "END signal from node " << signalID;
 
-			list<ReceivedSignal_type>::iterator endingSignal;
-			for (endingSignal = receivedSignals.begin(); endingSignal != receivedSignals.end(); endingSignal++) {
-				if (endingSignal->ID == signalID)
-					break;
-			}
+			ReceivedSignalSet::iterator endingSignal = receivedSignals.find(signalID);
 
 			/* If we do not find the signal ID in our list of received signals
 			 * this means that the list was flushed, probably due to a carrier
 			 * frequency change. We can ignore the signal.
 			 */
 			if (endingSignal == receivedSignals.end()){
-				trace() << "END signal ingnored: No matching start signal, probably due to carrier freq change";
+				TRACE << "END signal ingnored: No matching start signal, probably due to carrier freq change";
 				break;	// exit case WC_SIGNAL_END
 			}
+			if (signalID == capturedSignalID)
+				capturedSignalID = -1;
 
 			/* If we are not in RX state or we are changing state, then just
 			 * delete the corresponding signal from the received signals list
 			 */
 			if ((state != RX) || (changingToState != -1)) {
 				if (endingSignal->bitErrors != ALL_ERRORS) {
-					stats.RxFailedNoRxState++;
-					trace() << "Failed packet (WC_SIGNAL_END) from node " << signalID << ", no RX state";
+					stats.RxFailedNoRxState += endingSignal->numOfFrames;
+					TRACE << "Failed packet (WC_SIGNAL_END) from node " << signalID << ", no RX state";
 				}
+				interferenceSegments.release(endingSignal->firstSegment, endingSignal->lastSegment);
 				receivedSignals.erase(endingSignal);
 				break;	// exit case WC_SIGNAL_END
 			}
@@ -203,16 +229,14 @@ void Radio::handleMessage(cMessage * msg)
 			/* If we are in RX state, go throught the list of received signals and update
 			 * bitErrors and currentInterference, just as we did with start signal.
 			 */
-			list<ReceivedSignal_type>::iterator it1;
+			ReceivedSignalSet::iterator it1;
 			for (it1 = receivedSignals.begin(); it1 != receivedSignals.end(); it1++) {
 				// no need to update bitErrors for an element which will not be received
 				if (it1->bitErrors == ALL_ERRORS || it1->bitErrors > maxErrorsAllowed(it1->encoding))
 					continue;
 
-				//calculate bit errors for the last segment of unchanged signal conditions
-				int numOfBits = (int)ceil(RXmode->datarate * SIMTIME_DBL(simTime() - timeOfLastSignalChange));
-				double BER = SNR2BER(it1->power_dBm - it1->currentInterference);
-				it1->bitErrors += bitErrors(BER, numOfBits, maxErrorsAllowed(it1->encoding) - it1->bitErrors);
+				// account for the last segment of unchanged signal conditions
+				updateBitErrors(it1);
 
 				//update currentInterference in the received signal structure (*it)
 				// only if this is NOT the ending signal
@@ -221,38 +245,23 @@ void Radio::handleMessage(cMessage * msg)
 			}
 
 			updateTotalPowerReceived(endingSignal);
+			updatePossibleCSinterrupt();
 			timeOfLastSignalChange = simTime();
 
 			// use bit errors and encoding type to determine if the packet is received
 			if (endingSignal->bitErrors != ALL_ERRORS) {
-				if (endingSignal->bitErrors <= maxErrorsAllowed(endingSignal->encoding)) {
-					// decapsulate the packet and add the RSSI and LQI fields
-					MacPacket *macPkt = check_and_cast<MacPacket*>(wcMsg->decapsulate());
-					macPkt->getMacRadioInfoExchange().RSSI = readRSSI();
-					macPkt->getMacRadioInfoExchange().LQI = endingSignal->power_dBm - endingSignal->maxInterference;
-					sendDelayed(macPkt, PROCESSING_DELAY, "toMacModule");
-					// collect stats
-					if (endingSignal->maxInterference == RXmode->noiseFloor) {
-						stats.RxReachedNoInterference++;
-						trace() << "Received packet (WC_SIGNAL_END) from node " << signalID << ", with no interference";
-					}
-					else {
-						stats.RxReachedInterference++;
-						trace() << "Received packet (WC_SIGNAL_END) from node " << signalID << ", despite interference";
-					}
+				if (endingSignal->numOfFrames > 1) {
+					receiveFrameTrain(*endingSignal, wcMsg);
 				} else {
-					// collect stats
-					if (endingSignal->maxInterference == RXmode->noiseFloor) {
-						stats.RxFailedNoInterference++;
-						trace() << "Failed packet (WC_SIGNAL_END) from node " << signalID << ", NO interference";
-					}
-					else {
-						stats.RxFailedInterference++;
-						trace() << "Failed packet (WC_SIGNAL_END) from node " << signalID << ", with interference";
-					}
+					// with deferred bit errors, they are decided now from all the segments
+					if (deferredBitErrors)
+						endingSignal->bitErrors = signalBitErrors(*endingSignal);
+					if (frameReceived(*endingSignal, endingSignal->bitErrors))
+						passToMac(check_and_cast<MacPacket*>(wcMsg->decapsulate()), *endingSignal);
 				}
 			}
 
+			interferenceSegments.release(endingSignal->firstSegment, endingSignal->lastSegment);
 			receivedSignals.erase(endingSignal);
 
 			break;
@@ -264,6 +273,9 @@ void Radio::handleMessage(cMessage * msg)
 		case RADIO_CONTROL_COMMAND:{
 			RadioControlCommand *radioCmd = check_and_cast<RadioControlCommand*>(msg);
 			handleRadioControlCommand(radioCmd);
+			// our own command to leave TX is reused, do not delete it
+			if (msg == leaveTxCommand)
+				return;
 			break;
 		}
 
@@ -271,12 +283,10 @@ void Radio::handleMessage(cMessage * msg)
 		 * Radio self message to complete the transition to a state
 		 ***********************************************************/
 		case RADIO_ENTER_STATE:{
-			/* make the stateTransitionMsg variable NULL, since it
-			 * also serves to indicate that a transition is happening
-			 */
-			stateTransitionMsg = NULL;
+			// stateTransitionMsg is reused, no longer scheduled it indicates
+			// that no transition is happening
 			completeStateTransition();
-			break;
+			return;
 		}
 
 
@@ -290,19 +300,15 @@ void Radio::handleMessage(cMessage * msg)
 				powerDrawn(TxLevel->txPowerConsumed);
 				// flush the total received power history
 				totalPowerReceived.clear();
-				scheduleAt(simTime() + timeToTxPacket, new cMessage("continueTX", RADIO_CONTINUE_TX));
+				scheduleAt(simTime() + timeToTxPacket, continueTxMsg);
 			} else {
 				// send a command to change to RX, or SLEEP
-				RadioControlCommand *radioCmd = new RadioControlCommand("TX->RX or SLEEP", RADIO_CONTROL_COMMAND);
-				radioCmd->setRadioControlCommandKind(SET_STATE);
-				if (stateAfterTX == SLEEP)
-					radioCmd->setState(SLEEP);
-				else 	radioCmd->setState(RX);
-				scheduleAt(simTime(), radioCmd);
-				trace() << "TX finished (no more pkts in the buffer) changing to " << (stateAfterTX == SLEEP ? "SLEEP" : "RX");
+				scheduleLeaveTx(stateAfterTX == SLEEP ? SLEEP : RX);
+				TRACE << "TX finished (no more pkts in the buffer) changing to " << (stateAfterTX == SLEEP ? "SLEEP" : "RX");
 				stateAfterTX = RX; // return to a default behaviour
 			}
-			break;
+			// continueTxMsg is reused, do not delete it
+			return;
 		}
 
 		/**************************************************************
@@ -313,13 +319,13 @@ void Radio::handleMessage(cMessage * msg)
 
 			int totalSize = macPkt->getByteLength() + PhyFrameOverhead;
 			if (maxPhyFrameSize != 0 && totalSize > maxPhyFrameSize) {
-				trace() << "WARNING: MAC sent to Radio an oversized packet (" <<
+				TRACE << "WARNING: MAC sent to Radio an oversized packet (" <<
 					macPkt->getByteLength() + PhyFrameOverhead << " bytes) packet dropped";
 				break;
 			}
 
 			if ((int)radioBuffer.size() < bufferSize) {
-				trace() << "Buffered [" << macPkt->getName() << "] from MAC layer";
+				TRACE << "Buffered [" << macPkt->getName() << "] from MAC layer";
 				radioBuffer.push(macPkt);
 				// we use return instead of break that leads to message deletion at the end
 				// to avoid unnecessary message duplication
@@ -330,7 +336,7 @@ void Radio::handleMessage(cMessage * msg)
 				fullBuffMsg->setRadioControlMessageKind(RADIO_BUFFER_FULL);
 				sendDelayed(fullBuffMsg, PROCESSING_DELAY, "toMacModule");
 				stats.bufferOverflow++;
-				trace() << "WARNING: Buffer FULL, discarding [" << macPkt->getName() << "] from MAC layer";
+				TRACE << "WARNING: Buffer FULL, discarding [" << macPkt->getName() << "] from MAC layer";
 			}
 			break;
 		}
@@ -339,13 +345,13 @@ void Radio::handleMessage(cMessage * msg)
 		 * Two kinds of messages to disable the radio
 		 ***************************************************/
 		case OUT_OF_ENERGY:{
-			trace() << "Radio disabled: Out of energy";
+			TRACE << "Radio disabled: Out of energy";
 			disabled = 1;
 			break;
 		}
 
 		case DESTROY_NODE:{
-			trace() << "Radio disabled: Destroyed node";
+			TRACE << "Radio disabled: Destroyed node";
 			disabled = 1;
 			break;
 		}
@@ -361,6 +367,8 @@ void Radio::handleMessage(cMessage * msg)
 		 * to avoid message deletion in the end;
 		 ******************************************************************/
 		case RADIO_CONTROL_MESSAGE:{
+			if (msg == CSinterruptMsg)
+				CSinterruptMsg = NULL;
 			send(msg, "toMacModule");
 			return;
 		}
@@ -406,8 +414,8 @@ void Radio::handleRadioControlCommand(RadioControlCommand * radioCmd)
 
 			changingToState = radioCmd->getState();
 
-			double transitionDelay = transition[state][changingToState].delay;
-			double avgDrawnTransitionPower = transition[state][changingToState].power;
+			double transitionDelay = profile->transition[state][changingToState].delay;
+			double avgDrawnTransitionPower = profile->transition[state][changingToState].power;
 
 			/* With sleep levels it gets a little more complicated. We can add the trans
 			 * delay from going to one sleep level to the other to get the total transDelay,
@@ -416,32 +424,22 @@ void Radio::handleRadioControlCommand(RadioControlCommand * radioCmd)
 			 * we receive another state change message? We would have to cancel these
 			 * messages. Instead we are calculating the average power and sending one
 			 * powerDrawn message. It might be a little less accurate in rare situations
-			 * (very fast state changes), but cleaner in implementation.
+			 * (very fast state changes), but cleaner in implementation. The way through
+			 * the sleep levels is precomputed in the radio profile.
 			 */
-			if (state == SLEEP) {
-				list<SleepLevel_type>::iterator it1 = sleepLevel;
-				while (it1 != sleepLevelList.begin()) {
-					double levelDelay = it1->transitionUp.delay;
-					double levelPower = it1->transitionUp.power;
-					avgDrawnTransitionPower = ((avgDrawnTransitionPower * transitionDelay) +
-							levelPower * levelDelay) / (transitionDelay + levelDelay);
-					transitionDelay += levelDelay;
-					it1--;
-				}
-			} else if (changingToState == SLEEP) {
-				list<SleepLevel_type>::iterator it1 = sleepLevelList.begin();
-				while (it1 != sleepLevel) {
-					double levelDelay = it1->transitionDown.delay;
-					double levelPower = it1->transitionDown.power;
-					avgDrawnTransitionPower = ((avgDrawnTransitionPower * transitionDelay) +
-							levelPower * levelDelay) / (transitionDelay + levelDelay);
-					transitionDelay += levelDelay;
-					it1++;
-				}
+			TransitionElement *levels = NULL;
+			if (state == SLEEP)
+				levels = &sleepLevel->toFirstLevel;
+			else if (changingToState == SLEEP)
+				levels = &sleepLevel->fromFirstLevel;
+			if (levels != NULL && levels->delay > 0) {
+				avgDrawnTransitionPower = ((avgDrawnTransitionPower * transitionDelay) +
+						levels->power * levels->delay) / (transitionDelay + levels->delay);
+				transitionDelay += levels->delay;
 			}
 
 			powerDrawn(avgDrawnTransitionPower);
-			trace() << "SET STATE to " << (changingToState == TX ? "TX" :
+			TRACE << "SET STATE to " << (changingToState == TX ? "TX" :
 					(changingToState == RX ? "RX" : "SLEEP")) << ", delay=" <<
 					transitionDelay << ", power=" << avgDrawnTransitionPower;
 
@@ -461,13 +459,16 @@ void Radio::handleRadioControlCommand(RadioControlCommand * radioCmd)
 		 * make all bitErrors = ALL_ERRORS, but not worth the trouble I think.
 		 */
 		case SET_MODE:{
-			// get the mode name from the command
-			string modeName(radioCmd->getName());
-			RXmode = parseRxMode(modeName);
-			trace() << "Changed RX mode to " << RXmode->name;
+			// get the mode index or name from the command
+			if (radioCmd->getIndex() >= 0)
+				RXmode = elementAtIndex(profile->RXmodeList, radioCmd->getIndex(), "RX mode");
+			else
+				RXmode = parseRxMode(string(radioCmd->getName()));
+			TRACE << "Changed RX mode to " << RXmode->name;
 
 			// update variables depended on RXmode
 			rssiIntegrationTime = symbolsForRSSI * RXmode->bitsPerSymbol / RXmode->datarate;
+			updatePossibleCSinterrupt();
 
 			// if we are in RX state then we should change our drawn power
 			if (state == RX)
@@ -476,45 +477,54 @@ void Radio::handleRadioControlCommand(RadioControlCommand * radioCmd)
 		}
 
 		case SET_TX_OUTPUT:{
-			TxLevel = parseTxLevel(radioCmd->getParameter());
-			trace() << "Changed TX power output to " << TxLevel->txOutputPower <<
+			if (radioCmd->getIndex() >= 0)
+				TxLevel = elementAtIndex(profile->TxLevelList, radioCmd->getIndex(), "TX level");
+			else
+				TxLevel = parseTxLevel(radioCmd->getParameter());
+			TRACE << "Changed TX power output to " << TxLevel->txOutputPower <<
 					" dBm, consuming " << TxLevel->txPowerConsumed << " mW";
 			break;
 		}
 
 		case SET_SLEEP_LEVEL:{
-			string sleepLevelName(radioCmd->getName());
-			sleepLevel = parseSleepLevel(sleepLevelName);
-			trace() << "Changed default sleep level to " << sleepLevel->name;
+			if (radioCmd->getIndex() >= 0)
+				sleepLevel = elementAtIndex(profile->sleepLevelList, radioCmd->getIndex(), "sleep level");
+			else
+				sleepLevel = parseSleepLevel(string(radioCmd->getName()));
+			TRACE << "Changed default sleep level to " << sleepLevel->name;
 			break;
 		}
 
 		case SET_CARRIER_FREQ:{
 			carrierFreq = radioCmd->getParameter();
-			trace() << "Changed carrier frequency to " << carrierFreq << " MHz";
+			TRACE << "Changed carrier frequency to " << carrierFreq << " MHz";
+			registerCarrierFreq();
 			/* The only measure we take is to clear the receivedSignals list,
 			 * as these signals are not valid anymore and in fact could wrongly
 			 * create intereference with newly coming signals.
 			 */
-			receivedSignals.clear();
+			clearReceivedSignals();
 			break;
 		}
 
 		case SET_CCA_THRESHOLD:{
 			CCAthreshold = radioCmd->getParameter();
-			trace() << "Changed CCA threshold to " << CCAthreshold << " dBm";
+			TRACE << "Changed CCA threshold to " << CCAthreshold << " dBm";
+			updatePossibleCSinterrupt();
 			break;
 		}
 
 		case SET_CS_INTERRUPT_ON:{
 			carrierSenseInterruptEnabled = true;
-			trace() << "CS interrupt tunrned ON";
+			TRACE << "CS interrupt tunrned ON";
+			updatePossibleCSinterrupt();
 			break;
 		}
 
 		case SET_CS_INTERRUPT_OFF:{
 			carrierSenseInterruptEnabled = false;
-			trace() << "CS interrupt tunrned OFF";
+			TRACE << "CS interrupt tunrned OFF";
+			updatePossibleCSinterrupt();
 			break;
 		}
 
@@ -534,20 +544,31 @@ void Radio::handleRadioControlCommand(RadioControlCommand * radioCmd)
  */
 void Radio::delayStateTransition(simtime_t delay)
 {
-	if (stateTransitionMsg!=NULL) {
-		trace() << "WARNING: command to change to a new state was received before previous state transition was completed";
-		cancelAndDelete(stateTransitionMsg);
+	if (stateTransitionMsg->isScheduled()) {
+		TRACE << "WARNING: command to change to a new state was received before previous state transition was completed";
+		cancelEvent(stateTransitionMsg);
 	}
-	stateTransitionMsg = new cMessage("Complete state transition", RADIO_ENTER_STATE);
 	scheduleAt(simTime() + delay, stateTransitionMsg);
 }
 
+/* Schedule our own command to change from TX to the given state, now.
+ * The command is a self message so it is not treated as an external
+ * request that only records stateAfterTX
+ */
+void Radio::scheduleLeaveTx(BasicState_type newState)
+{
+	if (leaveTxCommand->isScheduled())
+		cancelEvent(leaveTxCommand);
+	leaveTxCommand->setState(newState);
+	scheduleAt(simTime(), leaveTxCommand);
+}
+
 /* The function handles the actions needed when entering a new state.
  */
 void Radio::completeStateTransition()
 {
 	state = (BasicState_type) changingToState;
-	trace() << "completing transition to " << state << " (" <<
+	TRACE << "completing transition to " << state << " (" <<
 			(state == TX ? "TX" : (state == RX ? "RX" : "SLEEP")) << ")";
 	changingToState = -1;
 
@@ -559,14 +580,12 @@ void Radio::completeStateTransition()
 				powerDrawn(TxLevel->txPowerConsumed);
 				// flush the total received power history
 				totalPowerReceived.clear();
-				scheduleAt(simTime() + timeToTxPacket, new cMessage("continueTX", RADIO_CONTINUE_TX));
+				updatePossibleCSinterrupt();
+				scheduleAt(simTime() + timeToTxPacket, continueTxMsg);
 			} else {
 				// just changed to TX, but buffer empty, send a command to change to RX
-				RadioControlCommand *radioCmd = new RadioControlCommand("TX->RX", RADIO_CONTROL_COMMAND);
-				radioCmd->setRadioControlCommandKind(SET_STATE);
-				radioCmd->setState(RX);
-				scheduleAt(simTime(), radioCmd);
-				trace() << "WARNING: just changed to TX, but buffer is empty, changing to RX ";
+				scheduleLeaveTx(RX);
+				TRACE << "WARNING: just changed to TX, but buffer is empty, changing to RX ";
 			}
 			break;
 		}
@@ -584,6 +603,7 @@ void Radio::completeStateTransition()
 			powerDrawn(sleepLevel->power);
 			// flush the total received power history
 			totalPowerReceived.clear();
+			updatePossibleCSinterrupt();
 			break;
 		}
 
@@ -601,10 +621,13 @@ void Radio::finishSpecific()
 		radioBuffer.pop();
 		cancelAndDelete(macPkt);
 	}
-	TxLevelList.clear();
-	RXmodeList.clear();
-	sleepLevelList.clear();
-	receivedSignals.clear();
+	cancelAndDelete(stateTransitionMsg);
+	cancelAndDelete(continueTxMsg);
+	cancelAndDelete(leaveTxCommand);
+	stateTransitionMsg = continueTxMsg = NULL;
+	leaveTxCommand = NULL;
+
+	clearReceivedSignals();
 	totalPowerReceived.clear();
 
 	if (stats.transmissions > 0)
@@ -633,9 +656,6 @@ void Radio::finishSpecific()
  */
 double Radio::popAndSendToWirelessChannel()
 {
-	MacPacket *macPkt = radioBuffer.front();
-	radioBuffer.pop();
-
 	//Generate begin and end tx messages
 	WirelessChannelSignalBegin *begin =
 			new WirelessChannelSignalBegin("WC_BEGIN", WC_SIGNAL_START);
@@ -648,18 +668,39 @@ double Radio::popAndSendToWirelessChannel()
 
 	WirelessChannelSignalEnd *end =
 			new WirelessChannelSignalEnd("WC_END", WC_SIGNAL_END);
-	end->setByteLength(PhyFrameOverhead);
 	end->setNodeID(self);
-	end->encapsulate(macPkt);
+
+	if (burstTx && radioBuffer.size() > 1) {
+		/* Send all buffered frames back to back as one transmission. The train
+		 * is as long on air as the frames sent one after the other, and the
+		 * radio stays in TX all along, drawing the same power.
+		 */
+		RadioFrameTrain *train = new RadioFrameTrain("Frame train");
+		while (!radioBuffer.empty()) {
+			MacPacket *macPkt = radioBuffer.front();
+			radioBuffer.pop();
+			train->addFrame(macPkt, macPkt->getByteLength() + PhyFrameOverhead);
+			TRACE << "Frame " << train->getNumOfFrames() << " of train, " <<
+				macPkt->getByteLength() + PhyFrameOverhead << " bytes";
+		}
+		begin->setNumOfFrames(train->getNumOfFrames());
+		end->setByteLength(0);
+		end->encapsulate(train);
+		stats.transmissions += train->getNumOfFrames();
+	} else {
+		MacPacket *macPkt = radioBuffer.front();
+		radioBuffer.pop();
+		end->setByteLength(PhyFrameOverhead);
+		end->encapsulate(macPkt);
+		stats.transmissions++;
+	}
 
 	//calculate the TX time based on the length of the packet
 	double txTime = ((double)(end->getByteLength() * 8.0f)) / RXmode->datarate;
 	send(begin, "toCommunicationModule");
 	sendDelayed(end, txTime, "toCommunicationModule");
 
-	// keep stats of the packets TXed
-	stats.transmissions++;
-	trace() << "Sending Packet, Transmission will last " << txTime << " secs";
+	TRACE << "Sending Packet, Transmission will last " << txTime << " secs";
 	return txTime;
 }
 
@@ -668,33 +709,23 @@ double Radio::popAndSendToWirelessChannel()
  */
 void Radio::updateTotalPowerReceived(double newSignalPower)
 {
-	TotalPowerReceived_type newElement;
-	// we are assuming additive power. In reality it is more complex.
-	newElement.power_dBm =
-			addPower_dBm(totalPowerReceived.front().power_dBm, newSignalPower);
-	newElement.startTime = simTime();
-	totalPowerReceived.push_front(newElement);
+	/* The new signal is already in the received signals set, so the total
+	 * is the noise floor plus the running total of the set.
+	 * We are assuming additive power. In reality it is more complex.
+	 */
+	totalPowerReceived.add(addNoiseFloor_dBm(receivedSignals.totalPower_mW()), simTime(), rssiIntegrationTime);
 }
 
 /* Update the history of total power received. Overloaded method
  * This version is used when a signal ends
  */
-void Radio::updateTotalPowerReceived(list<ReceivedSignal_type>::iterator endingSignal)
+void Radio::updateTotalPowerReceived(ReceivedSignalSet::iterator endingSignal)
 {
-	TotalPowerReceived_type newElement;
-	newElement.power_dBm = RXmode->noiseFloor;
-	/* Go through the list of currently received signals and add up their powers
-	 * Do not include the endindSignal. Adding the powers is more accurate
-	 * than subtracting the endingSignal from the totalPower (errors accumulate)
+	/* The total power of the currently received signals, without the
+	 * endingSignal, is taken from the running total of the set in mW.
 	 * We are assuming additive power. In reality it is more complex.
 	 */
-	list<ReceivedSignal_type>::iterator it1;
-	for (it1 = receivedSignals.begin(); it1 != receivedSignals.end(); it1++) {
-		if (it1 != endingSignal)
-			newElement.power_dBm = addPower_dBm(newElement.power_dBm, it1->power_dBm);
-	}
-	newElement.startTime = simTime();
-	totalPowerReceived.push_front(newElement);
+	totalPowerReceived.add(addNoiseFloor_dBm(receivedSignals.totalPower_mW(endingSignal->power_mW)), simTime(), rssiIntegrationTime);
 }
 
 /* Update the history of total power received. Overloaded method
@@ -702,32 +733,28 @@ void Radio::updateTotalPowerReceived(list<ReceivedSignal_type>::iterator endingS
  */
 void Radio::updateTotalPowerReceived()
 {
-	TotalPowerReceived_type newElement;
-	newElement.power_dBm = RXmode->noiseFloor;
-	/* Go through the list of currently received signals and add up their powers
-	 * We are assuming additive power. In reality it is more complex.
-	 * Also do some housekeeping while calculating total power:
-	 * Signals already active when we just enter RX, cannot be received.
-	 * We tag them here as such
+	/* The total power of currently received signals is the running total of
+	 * the set. We are assuming additive power. In reality it is more complex.
+	 * Also do some housekeeping: signals already active when we just
+	 * enter RX, cannot be received. We tag them here as such
 	 */
-	list<ReceivedSignal_type>::iterator it1;
+	totalPowerReceived.add(addNoiseFloor_dBm(receivedSignals.totalPower_mW()), simTime(), rssiIntegrationTime);
+	ReceivedSignalSet::iterator it1;
 	for (it1 = receivedSignals.begin(); it1 != receivedSignals.end(); it1++) {
-		newElement.power_dBm = addPower_dBm(it1->power_dBm, newElement.power_dBm);
 		if (it1->bitErrors != ALL_ERRORS) {
-			stats.RxFailedNoRxState++;
-			trace() << "Just entered RX, existing signal from node " << it1->ID << " cannot be received";
+			stats.RxFailedNoRxState += it1->numOfFrames;
+			TRACE << "Just entered RX, existing signal from node " << it1->ID << " cannot be received";
 			it1->bitErrors = ALL_ERRORS;
+			interferenceSegments.release(it1->firstSegment, it1->lastSegment);
 		}
 	}
-	newElement.startTime = simTime();
-	totalPowerReceived.push_front(newElement);
 }
 
 /* Update interference of one element in the receivedSignals list. Overloaded method.
  * This version is used when a new signal starts (WC_SIGNAL_START)
  * Note that the last argument is a message
  */
-void Radio::updateInterference(list<ReceivedSignal_type>::iterator it1,
+void Radio::updateInterference(ReceivedSignalSet::iterator it1,
 					WirelessChannelSignalBegin * wcMsg)
 {
 	switch (collisionModel) {
@@ -746,16 +773,17 @@ void Radio::updateInterference(list<ReceivedSignal_type>::iterator it1,
 			return;
 		}
 
-		case ADDITIVE_INTERFERENCE_MODEL:{
-			it1->currentInterference = addPower_dBm(it1->currentInterference, wcMsg->getPower_dBm());
+		case ADDITIVE_INTERFERENCE_MODEL:
+		case COMPLEX_INTERFERENCE_MODEL:{
+			/* The new signal is not in the set yet, so interference is the
+			 * running total of the set, minus the signal itself, plus the new signal
+			 */
+			it1->currentInterference = addNoiseFloor_dBm(receivedSignals.totalPower_mW(it1->power_mW) +
+					dBmTomW(wcMsg->getPower_dBm()));
 			if (it1->currentInterference > it1->maxInterference)
 				it1->maxInterference = it1->currentInterference;
 			return;
 		}
-
-		case COMPLEX_INTERFERENCE_MODEL:{
-			return;
-		}		// not implemented yet
 	}
 }
 
@@ -763,8 +791,8 @@ void Radio::updateInterference(list<ReceivedSignal_type>::iterator it1,
  * This version is used when a new signal ends (WC_SIGNAL_END)
  * note that the last argument is an iterator to a list (the ending signal)
  */
-void Radio::updateInterference(list<ReceivedSignal_type>::iterator remainingSignal,
-					list<ReceivedSignal_type>::iterator endingSignal)
+void Radio::updateInterference(ReceivedSignalSet::iterator remainingSignal,
+					ReceivedSignalSet::iterator endingSignal)
 {
 	switch (collisionModel) {
 
@@ -776,141 +804,416 @@ void Radio::updateInterference(list<ReceivedSignal_type>::iterator remainingSign
 			return;
 		}		// do nothing, this signal corrupted/destroyed other signals already
 
-		case ADDITIVE_INTERFERENCE_MODEL:{
-			/* Calculate interference by going  through the list of currently received signals
-	 		 * currently received signal (except from endingSigngal and self) and add them up.
-	 		 * This is more accurate than subtracting the endingSignal power from the
-	 		 * current interference because in the second case, errors can accumulate
-			 * (substractPower_dBm and addPower_dBm return only approximate results)
-	 		 */
-			remainingSignal->currentInterference = RXmode->noiseFloor;
-			list<ReceivedSignal_type>::iterator it1;
-			for (it1 = receivedSignals.begin(); it1 != receivedSignals.end(); it1++) {
-				if (it1 == remainingSignal || it1 == endingSignal)
-					continue;
-				remainingSignal->currentInterference = addPower_dBm(remainingSignal->currentInterference, it1->power_dBm);
-			}
+		case ADDITIVE_INTERFERENCE_MODEL:
+		case COMPLEX_INTERFERENCE_MODEL:{
+			/* Interference is the power of all currently received signals except
+			 * from endingSignal and self. Both are subtracted in mW from the running
+			 * total of the set, which is exact (unlike subtractPower_dBm) and is
+			 * periodically summed again so that errors do not accumulate.
+			 */
+			remainingSignal->currentInterference = addNoiseFloor_dBm(
+					receivedSignals.totalPower_mW(remainingSignal->power_mW + endingSignal->power_mW));
 			return;
 		}
+	}
+}
 
-		case COMPLEX_INTERFERENCE_MODEL:{
-			return;
-		}		// not implemented yet
+/* Account for the segment of unchanged signal conditions that ends now, for
+ * a signal that can still be received. By default the bit errors of the
+ * segment are drawn right away. With deferred bit errors (always the case
+ * for the complex model) only the SINR and length of the segment are recorded,
+ * and bit errors are decided once when the signal ends. Signals lost in the
+ * meantime, to a state change or capture, never pay for the evaluation.
+ */
+void Radio::updateBitErrors(ReceivedSignalSet::iterator it1)
+{
+	int numOfBits = (int)ceil(RXmode->datarate * SIMTIME_DBL(simTime() - timeOfLastSignalChange));
+	if (deferredBitErrors || it1->numOfFrames > 1)
+		interferenceSegments.append(it1->firstSegment, it1->lastSegment,
+				it1->power_dBm - it1->currentInterference, numOfBits);
+	else
+		it1->bitErrors += bitErrors(it1->power_dBm - it1->currentInterference,
+				numOfBits, maxErrorsAllowed(it1->encoding) - it1->bitErrors);
+}
+
+/* Decide the bit errors of the next numOfBits bits of a signal from its SINR
+ * segments, with a single random number. The segment cursor (index of the
+ * segment and bits of it already used) is advanced past these bits. The
+ * distribution of 0 .. maxErrors errors is carried through the segments,
+ * convolving it with the binomial distribution of errors in each segment
+ * (truncated to maxErrors as well). Returns maxErrors + 1 if the bits are lost.
+ */
+int Radio::segmentBitErrors(int &segment, int &usedBits, int numOfBits, int maxErrors)
+{
+	errorDistribution.assign(maxErrors + 1, 0.0);
+	errorDistribution[0] = 1.0;
+	bool lost = false;
+
+	while (segment != -1 && numOfBits > 0) {
+		const InterferenceSegment &current = interferenceSegments[segment];
+		int bits = current.numOfBits - usedBits;
+		if (bits > numOfBits)
+			bits = numOfBits;
+		numOfBits -= bits;
+		usedBits += bits;
+		if (usedBits >= current.numOfBits) {
+			segment = current.next;
+			usedBits = 0;
+		}
+		if (lost)
+			continue;	// only advancing the cursor
+
+		double BER, logNoError;
+		lookupBER(current.SINR_dB, BER, logNoError);
+		if (BER <= 0.0)
+			continue;
+		if (BER >= 1.0) {
+			lost = true;
+			continue;
+		}
+		// exp(x) = 10^(x/ln(10)), the same table based conversion as dBm to mW
+		double noErrorProb = dBmTomW(bits * logNoError * (10.0 / M_LN10));
+		double ratio = BER / (1.0 - BER);
+		double totalProb = 0.0;
+		for (int k = maxErrors; k >= 0; k--) {
+			// P(k errors so far) = sum over j of P(k-j errors before) * P(j errors in segment)
+			double prob = 0.0, segmentProb = noErrorProb;
+			for (int j = 0; j <= k; j++) {
+				prob += errorDistribution[k - j] * segmentProb;
+				segmentProb *= (double)(bits - j) / (j + 1) * ratio;
+			}
+			errorDistribution[k] = prob;
+			totalProb += prob;
+		}
+		if (totalProb <= 0.0)
+			lost = true;
+	}
+	if (lost)
+		return maxErrors + 1;
+
+	double randomValue = genk_dblrand(0);
+	double cumulativeProb = 0.0;
+	for (int k = 0; k <= maxErrors; k++) {
+		cumulativeProb += errorDistribution[k];
+		if (randomValue < cumulativeProb)
+			return k;
 	}
+	return maxErrors + 1;
 }
 
-/* Calculate RSSI based on the history of totalReceivedPower
+/* Decide the bit errors of a whole signal from its SINR segments, which are released
  */
-double Radio::readRSSI()
+int Radio::signalBitErrors(ReceivedSignal_type &signal)
 {
+	int segment = signal.firstSegment, usedBits = 0;
+	int errors = segmentBitErrors(segment, usedBits, INT_MAX, maxErrorsAllowed(signal.encoding));
+	interferenceSegments.release(signal.firstSegment, signal.lastSegment);
+	return errors;
+}
 
-	double RSSI = -200.0; // initialize to a very small value
+/* Use bit errors and encoding type to determine if a frame of the signal
+ * is received, and collect stats
+ */
+bool Radio::frameReceived(ReceivedSignal_type &signal, int bitErrors)
+{
+	if (bitErrors <= maxErrorsAllowed(signal.encoding)) {
+		if (signal.maxInterference == RXmode->noiseFloor) {
+			stats.RxReachedNoInterference++;
+			TRACE << "Received packet (WC_SIGNAL_END) from node " << signal.ID << ", with no interference";
+		}
+		else {
+			stats.RxReachedInterference++;
+			TRACE << "Received packet (WC_SIGNAL_END) from node " << signal.ID << ", despite interference";
+		}
+		return true;
+	}
 
+	if (signal.maxInterference == RXmode->noiseFloor) {
+		stats.RxFailedNoInterference++;
+		TRACE << "Failed packet (WC_SIGNAL_END) from node " << signal.ID << ", NO interference";
+	}
+	else {
+		stats.RxFailedInterference++;
+		TRACE << "Failed packet (WC_SIGNAL_END) from node " << signal.ID << ", with interference";
+	}
+	return false;
+}
+
+/* Add the RSSI and LQI fields to a received packet and pass it to the MAC
+ */
+void Radio::passToMac(MacPacket *macPkt, ReceivedSignal_type &signal)
+{
+	macPkt->getMacRadioInfoExchange().RSSI = readRSSI();
+	macPkt->getMacRadioInfoExchange().LQI = signal.power_dBm - signal.maxInterference;
+	sendDelayed(macPkt, PROCESSING_DELAY, "toMacModule");
+}
+
+/* Decide the reception of each frame in a train from the SINR segments of
+ * the signal that fall within the frame. The last frame takes any bits left
+ * from rounding the segment lengths. All received frames are passed to the MAC
+ * now, at the end of the train. The segments are released.
+ */
+void Radio::receiveFrameTrain(ReceivedSignal_type &signal, WirelessChannelSignalEnd *wcMsg)
+{
+	RadioFrameTrain *train = check_and_cast<RadioFrameTrain*>(wcMsg->decapsulate());
+	int maxErrors = maxErrorsAllowed(signal.encoding);
+	int segment = signal.firstSegment, usedBits = 0;
+	for (int i = 0; i < train->getNumOfFrames(); i++) {
+		int errors = signal.bitErrors;	// already lost with the simple collision model
+		if (errors <= maxErrors) {
+			int numOfBits = (i == train->getNumOfFrames() - 1) ? INT_MAX : train->getFrameByteLength(i) * 8;
+			errors = segmentBitErrors(segment, usedBits, numOfBits, maxErrors);
+		}
+		if (frameReceived(signal, errors))
+			passToMac(train->removeFrame(i), signal);
+	}
+	interferenceSegments.release(signal.firstSegment, signal.lastSegment);
+	delete train;
+}
+
+/* Capture effect of the complex interference model. The receiver is locked
+ * on one signal at a time. A new signal that can be received takes over
+ * only if it is stronger than the locked signal by captureThreshold, and
+ * the locked signal is lost. Otherwise the new signal is not received and
+ * only acts as interference.
+ */
+void Radio::captureSignal(ReceivedSignal_type &newSignal)
+{
+	ReceivedSignalSet::iterator locked = receivedSignals.find(capturedSignalID);
+	if (capturedSignalID == -1 || locked == receivedSignals.end() || locked->bitErrors == ALL_ERRORS) {
+		capturedSignalID = newSignal.ID;
+		return;
+	}
+
+	if (newSignal.power_dBm >= locked->power_dBm + captureThreshold) {
+		stats.RxFailedInterference += locked->numOfFrames;
+		TRACE << "Failed packet (WC_SIGNAL_START) from node " << locked->ID <<
+			", receiver captured by stronger signal from node " << newSignal.ID;
+		locked->bitErrors = ALL_ERRORS;
+		interferenceSegments.release(locked->firstSegment, locked->lastSegment);
+		capturedSignalID = newSignal.ID;
+	} else {
+		stats.RxFailedInterference += newSignal.numOfFrames;
+		TRACE << "Failed packet (WC_SIGNAL_START) from node " << newSignal.ID <<
+			", receiver locked on signal from node " << locked->ID;
+		newSignal.bitErrors = ALL_ERRORS;
+	}
+}
+
+/* Forget all received signals, with their interference segments
+ */
+void Radio::clearReceivedSignals()
+{
+	receivedSignals.clear();
+	interferenceSegments.clear();
+	capturedSignalID = -1;
+}
+
+/* Calculate RSSI based on the history of totalReceivedPower. The history
+ * keeps a running integral of the power in mW, so the average over the
+ * integration time is read directly and converted to dBm only at the end
+ */
+double Radio::readRSSI()
+{
 	// if we are not RXing return the appropriate error code
 	if (state != RX)
 		return CS_NOT_VALID;
 
-	simtime_t limitTime = simTime() - rssiIntegrationTime;
-	simtime_t currentTime = simTime();
-
-	list<TotalPowerReceived_type>::iterator it1 = totalPowerReceived.begin();
-	while (currentTime > limitTime) {
-		// fraction of rssiIntegrationTime that the current element in TotalreceivedPower is active
-		float fractionTime = SIMTIME_DBL(currentTime - max(it1->startTime, limitTime)) / rssiIntegrationTime;
-		// RSSI in dBm being progressively computed
-		RSSI = addPower_dBm(it1->power_dBm + ratioTodB(fractionTime), RSSI);
-		currentTime = it1->startTime;
-		it1++;
-		if (it1 == totalPowerReceived.end())
-			break;
-	}
-	// if we have not RXed long enough, then return an error code
-	if (currentTime > limitTime)
+	if (totalPowerReceived.empty())
 		return CS_NOT_VALID_YET;
 
 	// special case when a naive model is needed: the current total signal power returned immediately
-	if (rssiIntegrationTime <= 0) {
-		RSSI = it1->power_dBm;
-		it1++;
-	}
+	if (rssiIntegrationTime <= 0)
+		return totalPowerReceived.latest().power_dBm;
+
+	// if we have not RXed long enough, then return an error code
+	double RSSI_mW;
+	if (!totalPowerReceived.average_mW(simTime(), rssiIntegrationTime, RSSI_mW))
+		return CS_NOT_VALID_YET;
 
-	// the rest of the elements are now irrelevant and should be deleted
-	totalPowerReceived.erase(it1, totalPowerReceived.end());
-	return RSSI;
+	return (RSSI_mW > 0.0) ? mWTodBm(RSSI_mW) : -200.0;
 }
 
-/* A method to calculate a possible carrier sense in the future
- * and schedule a message to notify layers above. Since the
- * received power history is expressed in dBm, exact computations
- * are complex. Instead we assume that all previous received power
- * is negligibly small and given the current power, CCAthreshold
- * and averaging/integration time for RSSI.
+/* A method to calculate a possible carrier sense in the future and
+ * schedule a message to notify layers above. It is called whenever the
+ * total received power changes. The exact time at which RSSI reaches
+ * CCAthreshold is solved from the received power history, assuming the
+ * current power does not change. At most one interrupt message is pending,
+ * it is moved if the crossing time changes and cancelled if there is no
+ * crossing anymore, so one interrupt is delivered per actual crossing.
  */
 void Radio::updatePossibleCSinterrupt()
 {
+	simtime_t crossingTime;
+	if (!carrierSenseInterruptEnabled || state != RX ||
+	    !totalPowerReceived.crossingTime(simTime(), rssiIntegrationTime, dBmTomW(CCAthreshold), crossingTime)) {
+		if (CSinterruptMsg != NULL) {
+			cancelAndDelete(CSinterruptMsg);
+			CSinterruptMsg = NULL;
+		}
+		return;
+	}
+
+	crossingTime += PROCESSING_DELAY;
+	if (CSinterruptMsg != NULL) {
+		if (CSinterruptMsg->getArrivalTime() == crossingTime)
+			return;
+		cancelEvent(CSinterruptMsg);
+	} else {
+		CSinterruptMsg = new RadioControlMessage("CS Interrupt", RADIO_CONTROL_MESSAGE);
+		CSinterruptMsg->setRadioControlMessageKind(CARRIER_SENSE_INTERRUPT);
+	}
+	// schedule it as a self message, so we can move or cancel it if needed
+	scheduleAt(crossingTime, CSinterruptMsg);
+}
+
+/* The noise floor of the current RX mode, raised by the aggregate power
+ * of signals that the wireless channel does not deliver to us as messages
+ * (the weak interference tier). Only used with the additive and complex
+ * interference models, other models keep the plain noise floor of the RX mode.
+ */
+double Radio::currentNoiseFloor()
+{
+	if ((collisionModel != ADDITIVE_INTERFERENCE_MODEL && collisionModel != COMPLEX_INTERFERENCE_MODEL) ||
+	    !wirelessChannelModule)
+		return RXmode->noiseFloor;
+	double weakInterference = wirelessChannelModule->getWeakInterference_mW(self);
+	if (weakInterference <= 0.0)
+		return RXmode->noiseFloor;
+	return mWTodBm(dBmTomW(RXmode->noiseFloor) + weakInterference);
+}
 
-	// if we are above the threshold, no point in scheduling an interrupt
-	if (readRSSI() > CCAthreshold)
+/* Adds the power of received signals (in mW) to the current noise floor,
+ * result in dBm. With no signal power the noise floor is returned as is,
+ * so that comparisons of interference with the noise floor stay exact.
+ */
+double Radio::addNoiseFloor_dBm(double signalPower_mW)
+{
+	double noiseFloor = currentNoiseFloor();
+	if (signalPower_mW <= 0.0)
+		return noiseFloor;
+	return mWTodBm(dBmTomW(noiseFloor) + signalPower_mW);
+}
+
+/* BER and log(1 - BER) for the current RX mode, interpolated from its
+ * tables when the SNR is within their range, computed directly otherwise
+ */
+void Radio::lookupBER(double SNR_dB, double &BER, double &logNoError)
+{
+	if (RXmode->BERtable.empty() || SNR_dB < BER_TABLE_MIN_SNR || SNR_dB >= BER_TABLE_MAX_SNR) {
+		BER = SNR2BER(*RXmode, SNR_dB);
+		logNoError = (BER < 1.0) ? log1p(-BER) : -HUGE_VAL;
 		return;
+	}
+	double position = (SNR_dB - BER_TABLE_MIN_SNR) / BER_TABLE_STEP;
+	int index = (int)position;
+	double a = position - index;
+	BER = (1 - a) * RXmode->BERtable[index] + a * RXmode->BERtable[index + 1];
+	logNoError = (1 - a) * RXmode->logNoErrorTable[index] + a * RXmode->logNoErrorTable[index + 1];
+}
 
-	// if we are going to schedule an interrupt, cancel any future CS interrupt
-	if (simTime() < latestCSinterruptTime)
-		cancelAndDelete(CSinterruptMsg);
+/* Parse the adjacent channel rejection mask, a list of "offset:rejection"
+ * pairs (MHz and dB) separated by commas or spaces
+ */
+void Radio::parseChannelRejectionMask(const char *mask)
+{
+	channelRejectionMask.clear();
+	cStringTokenizer t(mask, ", \t");
+	const char *ct;
+	while ((ct = t.nextToken())) {
+		ChannelRejectionElement element;
+		if (sscanf(ct, "%lf:%lf", &element.offset, &element.rejection) != 2 ||
+		    element.offset <= 0 || element.rejection < 0)
+			opp_error("Bad syntax of adjacentChannelRejection, expecting offset:rejection with positive offset in MHz and rejection in dB:\n%s", ct);
+		if (!channelRejectionMask.empty() && element.offset <= channelRejectionMask.back().offset)
+			opp_error("Bad syntax of adjacentChannelRejection, offsets must be increasing:\n%s", ct);
+		channelRejectionMask.push_back(element);
+	}
+}
 
-	/* We calculate the fraction of the RSSI averaging time that it will take for
-	 * the current power to surpass the CCA threshold. This is based on how many
-	 * times larger is the current time from the CCAthreshold. E.g., if it is
-	 * 2 times larger the fraction is 1/2, if it is 8, the fraction is 1/8
-	 */
-	float fractionTime = 1.0 / dBToRatio(totalPowerReceived.front().power_dBm - CCAthreshold);
-
-	// we might adjust the fraction based on symbolsForRSSI. E.g. if symbolsForRSSI
-	// is 4 and we get 1/8 then we might adjust it to 1/4. We do not have enough
-	// details for the RSSI model calculation though.
-
-	// schedule message
-	CSinterruptMsg = new RadioControlMessage("CS Interrupt", RADIO_CONTROL_MESSAGE);
-	CSinterruptMsg->setRadioControlMessageKind(CARRIER_SENSE_INTERRUPT);
-	latestCSinterruptTime = simTime() + rssiIntegrationTime * fractionTime + PROCESSING_DELAY;
-	// schedule it as a self message, so we can cancel it if needed
-	scheduleAt(latestCSinterruptTime, CSinterruptMsg);
-	return;
+/* Attenuation (in dB) of a signal at the given frequency offset from our
+ * carrier frequency, interpolated from the rejection mask. Returns -1 if the
+ * signal is beyond the mask and not heard at all.
+ */
+double Radio::channelRejection(double offset)
+{
+	if (offset == 0)
+		return 0.0;
+	if (channelRejectionMask.empty() || offset > channelRejectionMask.back().offset)
+		return -1.0;
+	double lowOffset = 0.0, lowRejection = 0.0;
+	for (int i = 0; i < (int)channelRejectionMask.size(); i++) {
+		if (offset <= channelRejectionMask[i].offset) {
+			double a = (offset - lowOffset) / (channelRejectionMask[i].offset - lowOffset);
+			return (1 - a) * lowRejection + a * channelRejectionMask[i].rejection;
+		}
+		lowOffset = channelRejectionMask[i].offset;
+		lowRejection = channelRejectionMask[i].rejection;
+	}
+	return -1.0;
+}
+
+/* Tell the wireless channel which frequencies we can hear, so that
+ * signals on other channels are not delivered to us. Radios that add the
+ * weak interference to their noise floor also ask to hear about its changes
+ */
+void Radio::registerCarrierFreq()
+{
+	if (!wirelessChannelModule)
+		return;
+	wirelessChannelModule->setReceiverFrequency(self, carrierFreq,
+		channelRejectionMask.empty() ? 0.0 : channelRejectionMask.back().offset);
+	if (collisionModel == ADDITIVE_INTERFERENCE_MODEL || collisionModel == COMPLEX_INTERFERENCE_MODEL)
+		wirelessChannelModule->setWeakInterferenceListener(self, this);
+}
+
+/* Direct method call from the wireless channel: the weak interference in
+ * our cell changed, which moves our noise floor. While in RX this is handled
+ * like any other change of signal conditions: the segment that ends now is
+ * accounted for, then interference, RSSI history and the possible carrier
+ * sense interrupt are updated. Outside RX the noise floor is read again
+ * when we enter RX.
+ */
+void Radio::weakInterferenceChanged()
+{
+	Enter_Method_Silent();
+	if (disabled || state != RX || changingToState != -1)
+		return;
+
+	ReceivedSignalSet::iterator it1;
+	for (it1 = receivedSignals.begin(); it1 != receivedSignals.end(); it1++) {
+		if (it1->bitErrors == ALL_ERRORS || it1->bitErrors > maxErrorsAllowed(it1->encoding))
+			continue;
+		updateBitErrors(it1);
+		it1->currentInterference = addNoiseFloor_dBm(receivedSignals.totalPower_mW(it1->power_mW));
+		if (it1->currentInterference > it1->maxInterference)
+			it1->maxInterference = it1->currentInterference;
+	}
+	totalPowerReceived.add(addNoiseFloor_dBm(receivedSignals.totalPower_mW()), simTime(), rssiIntegrationTime);
+	updatePossibleCSinterrupt();
+	timeOfLastSignalChange = simTime();
 }
 
 /* A method to convert SNR to BER for all the modulation types we support
  */
-double Radio::SNR2BER(double SNR_dB)
+double Radio::SNR2BER(RXmode_type &mode, double SNR_dB)
 {
-	switch (RXmode->modulation) {
+	switch (mode.modulation) {
 
 		case FSK:
-			return 0.5 * exp(((-0.5) * RXmode->noiseBandwidth / RXmode->datarate) * pow(10.0, (SNR_dB / 10.0)));
+			return 0.5 * exp(((-0.5) * mode.noiseBandwidth / mode.datarate) * pow(10.0, (SNR_dB / 10.0)));
 
 		case PSK:
-			return 0.5 * erfc(sqrt(pow(10.0, (SNR_dB / 10.0)) * RXmode->noiseBandwidth / RXmode->datarate));
+			return 0.5 * erfc(sqrt(pow(10.0, (SNR_dB / 10.0)) * mode.noiseBandwidth / mode.datarate));
 
 		case DIFFBPSK:
-			return 0.5 * exp(-(RXmode->noiseBandwidth / RXmode->datarate) * pow(10.0, (SNR_dB / 10.0)));
+			return 0.5 * exp(-(mode.noiseBandwidth / mode.datarate) * pow(10.0, (SNR_dB / 10.0)));
 
 		case DIFFQPSK:
 			return diffQPSK_SNR2BER(SNR_dB);
 
-		case CUSTOM:{
-			if (customModulation[0].SNR > SNR_dB)
-				return 0.0;
-			if (customModulation.back().SNR < SNR_dB)
-				return 1.0;
-			for (int i = 0; i < (int)customModulation.size() - 1; i++) {
-				if (customModulation[i + 1].SNR < SNR_dB)
-					continue;
-				if (customModulation[i + 1].SNR - SNR_dB > SNR_dB - customModulation[i].SNR)
-					return customModulation[i].BER;
-				else
-					return customModulation[i + 1].BER;
-			}
-			// went through the whole array
-			return 1.0;
-		}
+		case CUSTOM:
+			return customModulationBER(SNR_dB);
 
 		case IDEAL:
 			return (SNR_dB < IDEAL_MODULATION_THRESHOLD ? 1.0 : 0.0);
@@ -942,24 +1245,58 @@ CCA_result Radio::isChannelClear()
 		return CS_NOT_VALID_YET;
 }
 
-/* An advanced way of calculating the number of errors by checking if
- * exactly i errors happened, where i = 0..maxallowed.
+/* Sample BER and log(1 - BER) of an RX mode over the SNR range of the tables.
+ * Only the analytic modulation curves are tabulated, the rest are either
+ * lookups already (DIFFQPSK, CUSTOM) or trivial (IDEAL)
  */
-int Radio::bitErrors(double BER, int numOfBits, int maxBitErrorsAllowed)
+void Radio::buildBERTable(RXmode_type &mode)
 {
-	double cumulativeProbabilityOfUnrealizedEvents = 0.0;
+	mode.BERtable.clear();
+	mode.logNoErrorTable.clear();
+	if (mode.modulation != FSK && mode.modulation != PSK && mode.modulation != DIFFBPSK)
+		return;
 
-	int bitErrors;
-	for (bitErrors = 0; bitErrors <= maxBitErrorsAllowed; bitErrors++) {
-		double prob = probabilityOfExactly_N_Errors(BER, bitErrors, numOfBits);
+	int size = (int)ceil((BER_TABLE_MAX_SNR - BER_TABLE_MIN_SNR) / BER_TABLE_STEP) + 1;
+	mode.BERtable.resize(size);
+	mode.logNoErrorTable.resize(size);
+	for (int i = 0; i < size; i++) {
+		double BER = SNR2BER(mode, BER_TABLE_MIN_SNR + i * BER_TABLE_STEP);
+		mode.BERtable[i] = BER;
+		mode.logNoErrorTable[i] = log1p(-BER);
+	}
+}
 
-		if (genk_dblrand(0) <= prob / (1.0 - cumulativeProbabilityOfUnrealizedEvents))
-			break;
-		cumulativeProbabilityOfUnrealizedEvents += prob;
-		if (bitErrors == maxBitErrorsAllowed) {
-			bitErrors++;
-			break;
-		}
+/* Draw the number of bit errors in a segment of numOfBits bits received
+ * with the given SNR. A single random number is compared against the
+ * cumulative probability of 0, 1, .. maxBitErrorsAllowed errors, and
+ * maxBitErrorsAllowed + 1 is returned if it is above all of them.
+ * P(0 errors) = (1 - BER)^numOfBits is computed from the tabulated
+ * log(1 - BER) with one fast exponential, and each next probability
+ * follows from the previous one as P(k) = P(k-1) * (n-k+1)/k * BER/(1-BER)
+ */
+int Radio::bitErrors(double SNR_dB, int numOfBits, int maxBitErrorsAllowed)
+{
+	// one value is always drawn, also when the outcome is certain, so that the
+	// use of the random stream does not depend on the signal conditions
+	double randomValue = genk_dblrand(0);
+	if (numOfBits <= 0)
+		return 0;
+
+	double BER, logNoError;
+	lookupBER(SNR_dB, BER, logNoError);
+	if (BER >= 1.0)
+		return maxBitErrorsAllowed + 1;
+
+	// exp(x) = 10^(x/ln(10)), the same table based conversion as dBm to mW
+	double prob = dBmTomW(numOfBits * logNoError * (10.0 / M_LN10));
+	double cumulativeProb = prob;
+	int bitErrors = 0;
+	while (randomValue > cumulativeProb) {
+		if (bitErrors == maxBitErrorsAllowed)
+			return bitErrors + 1;
+		bitErrors++;
+		prob *= (double)(numOfBits - bitErrors + 1) / bitErrors * BER / (1.0 - BER);
+		cumulativeProb += prob;
 	}
 	return bitErrors;
 }
@@ -967,27 +1304,33 @@ int Radio::bitErrors(double BER, int numOfBits, int maxBitErrorsAllowed)
 void Radio::readIniFileParameters(void)
 {
 	bufferSize = par("bufferSize");
+	burstTx = par("burstTx");
 	maxPhyFrameSize = par("maxPhyFrameSize");
 	PhyFrameOverhead = par("phyFrameOverhead");
 	carrierFreq = par("carrierFreq");
+	parseChannelRejectionMask(par("adjacentChannelRejection"));
 	collisionModel = (CollisionModel_type) ((int)par("collisionModel"));
+	captureThreshold = par("captureThreshold");
+	deferredBitErrors = (collisionModel == COMPLEX_INTERFERENCE_MODEL) ||
+		(collisionModel == ADDITIVE_INTERFERENCE_MODEL && par("deferredBitErrors").boolValue());
 	CCAthreshold = par("CCAthreshold");
 	carrierSenseInterruptEnabled = par("carrierSenseInterruptEnabled");
 	symbolsForRSSI = par("symbolsForRSSI");
-	parseRadioParameterFile(par("RadioParametersFile"));
+	customModulationInterpolation = par("customModulationInterpolation");
+	loadRadioProfile(par("RadioParametersFile"));
 
 	string startingMode = par("mode");
 	RXmode = parseRxMode(startingMode);
-	trace() << "Initialized RX mode to " << RXmode->name;
+	TRACE << "Initialized RX mode to " << RXmode->name;
 
 	string startingTxPower = par("TxOutputPower");
 	TxLevel = parseTxLevel(startingTxPower);
-	trace() << "Initialized TX power output to " << TxLevel->txOutputPower <<
+	TRACE << "Initialized TX power output to " << TxLevel->txOutputPower <<
 			" dBm, consuming " << TxLevel->txPowerConsumed << " mW";
 
 	string defaultSleepLevel = par("sleepLevel");
 	sleepLevel = parseSleepLevel(defaultSleepLevel);
-	trace() << "Default sleep level initialized to " << sleepLevel->name;
+	TRACE << "Default sleep level initialized to " << sleepLevel->name;
 
 	string startingState = par("state");
 	state = RX;
@@ -999,23 +1342,89 @@ void Radio::readIniFileParameters(void)
 		changingToState = SLEEP;
 	else
 		opp_error("Unknown basic state name '%s'\n", startingState.c_str());
-
-	completeStateTransition();	// this will complete initialisation of the radio according to startingState parameter
 }
 
-void Radio::parseRadioParameterFile(const char *fileName)
+/* Radio profiles parsed so far, keyed by the file name and a hash of its
+ * content. They live as long as the process, so that consecutive runs with
+ * the same files do not parse them again, while an edited file is parsed anew.
+ */
+static map<string, RadioProfile*> radioProfileCache;
+
+// what is known about each radio parameters file, by file name
+struct RadioProfileFile {
+	RadioProfile *profile;
+	off_t size;
+	time_t mtime;
+	int run;	// last run that checked the file
+};
+static map<string, RadioProfileFile> radioProfileFiles;
+
+/* Point the radio to the profile of the given radio parameters file. The
+ * file is checked with stat() once per run, by the first radio using it, and
+ * only read and hashed when its size or modification time changed. It is
+ * parsed when no radio has loaded the same content before. All the radios of
+ * a network using one file then share its profile, including the BER tables,
+ * and do not keep a copy of their own.
+ */
+void Radio::loadRadioProfile(const char *fileName)
 {
 	if (strlen(fileName) == 0)
 		opp_error("Radio parameters file not specified");
-	ifstream f(fileName);
+
+	int run = ev.getConfigEx()->getActiveRunNumber();
+	map<string, RadioProfileFile>::iterator known = radioProfileFiles.find(fileName);
+	if (known != radioProfileFiles.end() && known->second.run == run) {
+		profile = known->second.profile;
+		return;
+	}
+	struct stat st;
+	if (stat(fileName, &st) != 0)
+		opp_error("Error reading from radio parameters file %s\n", fileName);
+	if (known != radioProfileFiles.end() && known->second.size == st.st_size &&
+			known->second.mtime == st.st_mtime) {
+		known->second.run = run;
+		profile = known->second.profile;
+		return;
+	}
+
+	ifstream f(fileName, ios::in | ios::binary);
 	if (!f.is_open())
 		opp_error("Error reading from radio parameters file %s\n", fileName);
+	string content((istreambuf_iterator<char>(f)), istreambuf_iterator<char>());
+
+	// 64 bit FNV-1a hash of the content
+	unsigned long long hash = 14695981039346656037ULL;
+	for (int i = 0; i < (int)content.size(); i++) {
+		hash ^= (unsigned char)content[i];
+		hash *= 1099511628211ULL;
+	}
+	ostringstream key;
+	key << fileName << "#" << hex << hash;
+
+	map<string, RadioProfile*>::iterator cached = radioProfileCache.find(key.str());
+	if (cached != radioProfileCache.end()) {
+		profile = cached->second;
+	} else {
+		profile = new RadioProfile();
+		parseRadioParameterFile(fileName, content);
+		radioProfileCache[key.str()] = profile;
+	}
+	RadioProfileFile &file = radioProfileFiles[fileName];
+	file.profile = profile;
+	file.size = st.st_size;
+	file.mtime = st.st_mtime;
+	file.run = run;
+}
 
+void Radio::parseRadioParameterFile(const char *fileName, const string &content)
+{
+	istringstream f(content);
 	string s;
 	const char *ct;
 	map<int,int> visited;
 	int section = -1;
 	// sections are -1: ERROR, 1: RX MODES, 2: TX LEVELS, 3: SLEEP LEVELS, 4: DELAY TRANSITION 5: POWER TRANSITION
+	// 6: CUSTOM MODULATION
 	while (getline(f, s)) {
 		// find and remove comments
 		size_t pos = s.find('#');
@@ -1050,6 +1459,9 @@ void Radio::parseRadioParameterFile(const char *fileName)
 		} else if (s.compare("POWER TRANSITION MATRIX") == 0) {
 			visited[section] = 1;
 			section = 5;
+		} else if (s.compare("CUSTOM MODULATION") == 0) {
+			visited[section] = 1;
+			section = 6;
 		} else if (section == -1 || visited[section] == 1)
 			opp_error("Bad syntax of radio parameters file, expecting label:\n%s", ct);
 		else {
@@ -1102,13 +1514,14 @@ void Radio::parseRadioParameterFile(const char *fileName)
 					opp_error("Bad syntax of radio parameters file, unexpected input for rx mode %s:\n%s",
 							rxmode.name.c_str(), ct);
 
-				list<RXmode_type>::iterator it1;
-				for (it1 = RXmodeList.begin(); it1 != RXmodeList.end(); it1++) {
+				vector<RXmode_type>::iterator it1;
+				for (it1 = profile->RXmodeList.begin(); it1 != profile->RXmodeList.end(); it1++) {
 					if (rxmode.name.compare(it1->name) == 0)
 						opp_error("Bad syntax of radio parameters file, duplicate RX mode %s",
 						     rxmode.name.c_str());
 				}
-				RXmodeList.push_back(rxmode);
+				buildBERTable(rxmode);
+				profile->RXmodeList.push_back(rxmode);
 
 			} else if (section == 2) {
 				// parsing lines in the following format:
@@ -1128,7 +1541,7 @@ void Radio::parseRadioParameterFile(const char *fileName)
 				else
 					opp_error("Bad syntax of radio parameters file, expecting Tx_dBm or Tx_mW label:\n%s", ct);
 
-				if (TxLevelList.empty()) {	// will insert new elements
+				if (profile->TxLevelList.empty()) {	// will insert new elements
 					while ((ct = t.nextToken())) {
 						TxLevel_type txlevel;
 						double tmp;
@@ -1138,11 +1551,11 @@ void Radio::parseRadioParameterFile(const char *fileName)
 							txlevel.txOutputPower = tmp;
 						else
 							txlevel.txPowerConsumed = tmp;
-						TxLevelList.push_back(txlevel);
+						profile->TxLevelList.push_back(txlevel);
 					}
 				} else {	// will modify existing elements
-					list <TxLevel_type>::iterator it1;
-					for (it1 = TxLevelList.begin(); it1 != TxLevelList.end(); it1++) {
+					vector<TxLevel_type>::iterator it1;
+					for (it1 = profile->TxLevelList.begin(); it1 != profile->TxLevelList.end(); it1++) {
 						ct = t.nextToken();
 						double tmp;
 						if (ct == NULL)
@@ -1173,7 +1586,7 @@ void Radio::parseRadioParameterFile(const char *fileName)
 							sleeplvl.name.c_str(), ct);
 				ct = t.nextToken();
 
-				if (sleepLevelList.empty()) {	//this is the first element, to txUp should be '-'
+				if (profile->sleepLevelList.empty()) {	//this is the first element, to txUp should be '-'
 					if (ct[0] != '-' || ct[1])
 						opp_error("Bad syntax of radio parameters file, expecting '-' as transition up delay for sleep level %s:\n%s",
 								sleeplvl.name.c_str(), ct);
@@ -1218,7 +1631,7 @@ void Radio::parseRadioParameterFile(const char *fileName)
 				if (ct != NULL)
 					opp_error("Bad syntax of radio parameters file, unexpected input for sleep level %s:\n%s",
 							sleeplvl.name.c_str(), ct);
-				sleepLevelList.push_back(sleeplvl);
+				profile->sleepLevelList.push_back(sleeplvl);
 
 			} else if (section == 4 || section == 5) {
 				// parsing lines in the following format:
@@ -1247,18 +1660,131 @@ void Radio::parseRadioParameterFile(const char *fileName)
 							opp_error("Bad syntax of radio parameters file, expecting state transition value from %i to %i:\n%s",
 									stateFrom, stateTo, ct);
 						if (section == 4)
-							transition[stateFrom][stateTo].delay = tmp / 1000.0;	//convert msec to sec
+							profile->transition[stateFrom][stateTo].delay = tmp / 1000.0;	//convert msec to sec
 						else
-							transition[stateFrom][stateTo].power = tmp;
+							profile->transition[stateFrom][stateTo].power = tmp;
 					}
 					stateFrom++;
 					ct = t.nextToken();
 				}
 				if (ct != NULL)
 					opp_error("Bad syntax of radio parameters file, unexpected input for transition matrix:\n%s", ct);
+
+			} else if (section == 6) {
+				// parsing lines in the following format:
+				// SNR(dB), BER
+
+				cStringTokenizer t(s.c_str(), ", \t");
+				CustomModulationElement element;
+				double tmp;
+				ct = t.nextToken();
+				if (ct == NULL || parseFloat(ct, &tmp))
+					opp_error("Bad syntax of radio parameters file, expecting SNR for custom modulation:\n%s", s.c_str());
+				element.SNR = tmp;
+				ct = t.nextToken();
+				if (ct == NULL || parseFloat(ct, &tmp) || tmp < 0.0 || tmp > 1.0)
+					opp_error("Bad syntax of radio parameters file, expecting BER in [0,1] for custom modulation:\n%s", s.c_str());
+				element.BER = tmp;
+				ct = t.nextToken();
+				if (ct != NULL)
+					opp_error("Bad syntax of radio parameters file, unexpected input for custom modulation:\n%s", ct);
+				profile->customModulation.push_back(element);
 			}
 		}
 	}
+
+	vector<RXmode_type>::iterator it1;
+	for (it1 = profile->RXmodeList.begin(); it1 != profile->RXmodeList.end(); it1++) {
+		if (it1->modulation == CUSTOM && profile->customModulation.empty())
+			opp_error("RX mode %s uses CUSTOM modulation, but radio parameters file %s has no CUSTOM MODULATION section",
+					it1->name.c_str(), fileName);
+	}
+	buildCustomModulationIndex();
+	buildSleepLevelTransitions();
+}
+
+/* Sum up the transitions through the sleep levels, from each level up to the
+ * first one and from the first one down to each level. Power is the average
+ * over the total delay, so the energy of the whole way is kept
+ */
+void Radio::buildSleepLevelTransitions()
+{
+	vector<SleepLevel_type> &levels = profile->sleepLevelList;
+	double delay = 0.0, energy = 0.0;
+	for (int i = 0; i < (int)levels.size(); i++) {
+		if (i > 0) {
+			delay += levels[i].transitionUp.delay;
+			energy += levels[i].transitionUp.delay * levels[i].transitionUp.power;
+		}
+		levels[i].toFirstLevel.delay = delay;
+		levels[i].toFirstLevel.power = delay > 0 ? energy / delay : 0.0;
+	}
+	delay = energy = 0.0;
+	for (int i = 0; i < (int)levels.size(); i++) {
+		levels[i].fromFirstLevel.delay = delay;
+		levels[i].fromFirstLevel.power = delay > 0 ? energy / delay : 0.0;
+		delay += levels[i].transitionDown.delay;
+		energy += levels[i].transitionDown.delay * levels[i].transitionDown.power;
+	}
+}
+
+static bool compareCustomModulationSNR(const CustomModulationElement &a, const CustomModulationElement &b)
+{
+	return a.SNR < b.SNR;
+}
+
+/* Sort the points of the custom modulation curve by SNR and build a uniform
+ * index over its SNR range, so that a lookup starts at most one or two
+ * points away from the right one instead of scanning the whole curve
+ */
+void Radio::buildCustomModulationIndex()
+{
+	vector<CustomModulationElement> &curve = profile->customModulation;
+	profile->customModulationIndex.clear();
+	if (curve.size() < 2)
+		return;
+
+	sort(curve.begin(), curve.end(), compareCustomModulationSNR);
+	int cells = CUSTOM_MODULATION_INDEX_RATIO * curve.size();
+	profile->customModulationStep = (curve.back().SNR - curve[0].SNR) / cells;
+	if (profile->customModulationStep <= 0)
+		opp_error("Bad syntax of radio parameters file, custom modulation points must have different SNRs");
+
+	profile->customModulationIndex.resize(cells + 1);
+	int point = 0;
+	for (int i = 0; i <= cells; i++) {
+		double cellSNR = curve[0].SNR + i * profile->customModulationStep;
+		while (point < (int)curve.size() - 2 && curve[point + 1].SNR <= cellSNR)
+			point++;
+		profile->customModulationIndex[i] = point;
+	}
+}
+
+/* BER of the custom modulation curve at the given SNR. SNRs beyond the
+ * ends of the curve get the BER of the end point. Within the curve, either
+ * the BER of the nearest point or a linear interpolation between the two
+ * points around SNR, depending on customModulationInterpolation
+ */
+double Radio::customModulationBER(double SNR_dB)
+{
+	const vector<CustomModulationElement> &curve = profile->customModulation;
+	if (SNR_dB <= curve[0].SNR)
+		return curve[0].BER;
+	if (SNR_dB >= curve.back().SNR)
+		return curve.back().BER;
+
+	// curve[i].SNR <= SNR_dB < curve[i + 1].SNR
+	int i = profile->customModulationIndex[(int)((SNR_dB - curve[0].SNR) / profile->customModulationStep)];
+	while (curve[i + 1].SNR <= SNR_dB)
+		i++;
+
+	if (customModulationInterpolation) {
+		double a = (SNR_dB - curve[i].SNR) / (curve[i + 1].SNR - curve[i].SNR);
+		return (1 - a) * curve[i].BER + a * curve[i + 1].BER;
+	}
+	if (curve[i + 1].SNR - SNR_dB > SNR_dB - curve[i].SNR)
+		return curve[i].BER;
+	return curve[i + 1].BER;
 }
 
 Modulation_type Radio::parseModulationType(const char *c)
@@ -1297,54 +1823,83 @@ Encoding_type Radio::parseEncodingType(const char *c)
 	return NRZ;
 }
 
-list<RXmode_type>::iterator Radio::parseRxMode(string modeName)
+vector<RXmode_type>::iterator Radio::parseRxMode(string modeName)
 {
 	if (modeName.compare("") == 0)
-		return RXmodeList.begin();
+		return profile->RXmodeList.begin();
 
-	list<RXmode_type>::iterator it1;
+	vector<RXmode_type>::iterator it1;
 	// find the mode in the list of RXmodes and assign it to RXmode
-	for (it1 = RXmodeList.begin(); it1 != RXmodeList.end(); it1++) {
+	for (it1 = profile->RXmodeList.begin(); it1 != profile->RXmodeList.end(); it1++) {
 		if (modeName.compare(it1->name) == 0)
 			return it1;
 	}
 	opp_error("Unknown radio RX mode %s", modeName.c_str());
-	return RXmodeList.end();
+	return profile->RXmodeList.end();
 }
 
-list<TxLevel_type>::iterator Radio::parseTxLevel(string txPower)
+vector<TxLevel_type>::iterator Radio::parseTxLevel(string txPower)
 {
 	if (txPower.compare("") == 0)
-		return TxLevelList.begin();
+		return profile->TxLevelList.begin();
 	double txPower_dBm;
 	if (parseFloat(txPower.c_str(), &txPower_dBm))
 		opp_error("Unable to parse TxOutputPower %s", txPower.c_str());
 	return parseTxLevel(txPower_dBm);
 }
 
-list<TxLevel_type>::iterator Radio::parseTxLevel(double txPower)
+vector<TxLevel_type>::iterator Radio::parseTxLevel(double txPower)
 {
-	list<TxLevel_type>::iterator it1;
-	for (it1 = TxLevelList.begin(); it1 != TxLevelList.end(); it1++) {
+	vector<TxLevel_type>::iterator it1;
+	for (it1 = profile->TxLevelList.begin(); it1 != profile->TxLevelList.end(); it1++) {
 		if (it1->txOutputPower == txPower)
 			return it1;
 	}
 	opp_error("Unknown Tx Output Power Level %f", txPower);
-	return TxLevelList.end();
+	return profile->TxLevelList.end();
 }
 
-list<SleepLevel_type>::iterator Radio::parseSleepLevel(string sleepLevelName)
+vector<SleepLevel_type>::iterator Radio::parseSleepLevel(string sleepLevelName)
 {
 	if (sleepLevelName.compare("") == 0)
-		return sleepLevelList.begin();
+		return profile->sleepLevelList.begin();
 
-	list<SleepLevel_type>::iterator it1;
-	for (it1 = sleepLevelList.begin(); it1 != sleepLevelList.end(); it1++) {
+	vector<SleepLevel_type>::iterator it1;
+	for (it1 = profile->sleepLevelList.begin(); it1 != profile->sleepLevelList.end(); it1++) {
 		if (sleepLevelName.compare(it1->name) == 0)
 			return it1;
 	}
 	opp_error("Unknown radio sleep level %s", sleepLevelName.c_str());
-	return sleepLevelList.end();
+	return profile->sleepLevelList.end();
+}
+
+/* Element of one of the RX mode, TX level and sleep level tables selected
+ * by the index given in a control command
+ */
+template <class T> typename vector<T>::iterator Radio::elementAtIndex(vector<T> &table, int index, const char *description)
+{
+	if (index >= (int)table.size())
+		opp_error("Radio control command with %s index %i, only %i defined", description, index, (int)table.size());
+	return table.begin() + index;
+}
+
+/* Index lookups for layers above. The index can be used in SET_MODE,
+ * SET_TX_OUTPUT and SET_SLEEP_LEVEL commands, so that switching between
+ * modes or levels does not search the tables by name or value each time
+ */
+int Radio::getRxModeIndex(const char *modeName)
+{
+	return parseRxMode(string(modeName)) - profile->RXmodeList.begin();
+}
+
+int Radio::getTxLevelIndex(double txPower)
+{
+	return parseTxLevel(txPower) - profile->TxLevelList.begin();
+}
+
+int Radio::getSleepLevelIndex(const char *sleepLevelName)
+{
+	return parseSleepLevel(string(sleepLevelName)) - profile->sleepLevelList.begin();
 }
 
 //wrapper function for atoi(...) call. returns 1 on error, 0 on success
@@ -1370,10 +1925,10 @@ int Radio::parseFloat(const char *c, double *dst)
 
 void Radio::ReceivedSignalDebug(const char *description)
 {
-	list<ReceivedSignal_type>::iterator it1;
-	trace() << "*** RECEIVED SIGNALS LIST DEBUG AT " << description << " ***";
+	ReceivedSignalSet::iterator it1;
+	TRACE << "*** RECEIVED SIGNALS LIST DEBUG AT " << description << " ***";
 	for (it1 = receivedSignals.begin(); it1 != receivedSignals.end(); it1++) {
-		trace() << "ID:" << it1->ID << ", power:" << it1->power_dBm << ", crIntrf:" <<
+		TRACE << "ID:" << it1->ID << ", power:" << it1->power_dBm << ", crIntrf:" <<
 				it1->currentInterference << ", bitErr:" << it1->bitErrors;
 	}
 }
@@ -15,10 +15,15 @@
 
 #include <map>
 #include <list>
+#include <vector>
+#include <algorithm>
 #include <queue>
+#include <climits>
 #include <omnetpp.h>
 #include <iostream>
 #include <fstream>
+#include <sstream>
+#include <sys/stat.h>
 
 #include "RadioSupportFunctions.h"
 #include "WirelessChannelMessages_m.h"
@@ -32,8 +37,22 @@
 
 #define PROCESSING_DELAY 0.00001	//delay to pass packets/messages/interrupts to upper layer
 
+#define BER_TABLE_MIN_SNR -10.0	// range and resolution (in dB) of the SNR->BER tables of RX modes
+#define BER_TABLE_MAX_SNR 30.0
+#define BER_TABLE_STEP 0.02
+
+#define CUSTOM_MODULATION_INDEX_RATIO 4	// index cells per point of the custom modulation curve
+
+#define SIGNAL_SET_INITIAL_SIZE 16	// signals the received signal set holds without reallocating
+#define SIGNAL_SET_RESUM_INTERVAL 64	// changes to the set after which the power total is summed again
+
+#define SEGMENT_ARENA_INITIAL_SIZE 64	// interference segments kept without reallocating
+#define POWER_HISTORY_INITIAL_SIZE 16	// total received power changes kept without reallocating (power of 2)
+
 using namespace std;
 
+class WirelessChannel;
+
 enum Modulation_type {
 	CUSTOM = 0,
 	IDEAL = 1,
@@ -67,21 +86,309 @@ struct RXmode_type {
 	double noiseBandwidth;
 	double noiseFloor;
 	double power;
+
+	// BER and log(1 - BER) sampled every BER_TABLE_STEP dB of SNR, starting
+	// at BER_TABLE_MIN_SNR. Empty for modulations without an analytic curve
+	vector<double> BERtable;
+	vector<double> logNoErrorTable;
 };
 
 struct ReceivedSignal_type {
 	int ID;			// an ID to distinguish between signals, in single radio nodes the nodeID will suffice
 	double power_dBm;	// in dBm
+	double power_mW;	// the same power in mW, set when the signal is added to the set
 	Modulation_type modulation;
 	Encoding_type encoding;
 	double currentInterference;	//in dBm
 	double maxInterference;	//in dBm
 	int bitErrors;		// number of bits with errors
+	int numOfFrames;	// more than 1 for a train of frames
+	int firstSegment;	// chain of SINR segments in the InterferenceSegmentArena,
+	int lastSegment;	// -1 if empty. Only used with deferred bit errors
+};
+
+struct InterferenceSegment {
+	float SINR_dB;
+	int numOfBits;
+	int next;		// next segment of the same signal, -1 for the last one
+};
+
+/* Storage for the SINR segments of all the signals being received. Segments
+ * of one signal form a chain through the arena, identified by the indices of
+ * its first and last segment. Segments released when a signal ends are kept
+ * in a free list and reused, so the arena stops growing once it holds the
+ * segments of the most signals received together.
+ */
+class InterferenceSegmentArena {
+ private:
+	vector<InterferenceSegment> segments;
+	int freeList;
+
+ public:
+	InterferenceSegmentArena(): freeList(-1) {
+		segments.reserve(SEGMENT_ARENA_INITIAL_SIZE);
+	}
+
+	// append a segment to a chain, merging it with the last one if the SINR is the same
+	void append(int &first, int &last, double SINR_dB, int numOfBits) {
+		if (numOfBits <= 0)
+			return;
+		if (last != -1 && segments[last].SINR_dB == (float)SINR_dB) {
+			segments[last].numOfBits += numOfBits;
+			return;
+		}
+		int index;
+		if (freeList != -1) {
+			index = freeList;
+			freeList = segments[index].next;
+		} else {
+			index = segments.size();
+			segments.push_back(InterferenceSegment());
+		}
+		segments[index].SINR_dB = SINR_dB;
+		segments[index].numOfBits = numOfBits;
+		segments[index].next = -1;
+		if (last != -1)
+			segments[last].next = index;
+		else
+			first = index;
+		last = index;
+	}
+
+	// return a whole chain to the free list
+	void release(int &first, int &last) {
+		if (first == -1)
+			return;
+		segments[last].next = freeList;
+		freeList = first;
+		first = last = -1;
+	}
+
+	const InterferenceSegment &operator[](int index) const { return segments[index]; }
+
+	void clear() {
+		segments.clear();
+		freeList = -1;
+	}
+};
+
+/* A flat set of the signals currently received. Signals are kept in a
+ * contiguous vector and a running total of their power in mW is updated as
+ * signals are added and removed, so the power of all other signals seen by
+ * one signal is a subtraction rather than a walk through the set. The total
+ * is Kahan compensated, and it is also summed again from the individual signals
+ * every SIGNAL_SET_RESUM_INTERVAL changes, so that rounding errors of the
+ * running total do not accumulate.
+ */
+class ReceivedSignalSet {
+ private:
+	vector<ReceivedSignal_type> signals;
+	double total_mW;
+	double compensation_mW;	// low order bits lost from total_mW
+	int changesSinceResum;
+
+	void addToTotal(double power_mW) {
+		double y = power_mW - compensation_mW;
+		double t = total_mW + y;
+		compensation_mW = (t - total_mW) - y;
+		total_mW = t;
+	}
+
+	void signalSetChanged() {
+		if (signals.empty()) {
+			total_mW = 0.0;
+			compensation_mW = 0.0;
+			changesSinceResum = 0;
+		} else if (++changesSinceResum >= SIGNAL_SET_RESUM_INTERVAL) {
+			total_mW = 0.0;
+			compensation_mW = 0.0;
+			for (int i = 0; i < (int)signals.size(); i++)
+				addToTotal(signals[i].power_mW);
+			changesSinceResum = 0;
+		}
+	}
+
+ public:
+	typedef vector<ReceivedSignal_type>::iterator iterator;
+
+	ReceivedSignalSet(): total_mW(0.0), compensation_mW(0.0), changesSinceResum(0) {
+		signals.reserve(SIGNAL_SET_INITIAL_SIZE);
+	}
+	iterator begin() { return signals.begin(); }
+	iterator end() { return signals.end(); }
+	bool empty() { return signals.empty(); }
+
+	iterator find(int ID) {
+		iterator it;
+		for (it = signals.begin(); it != signals.end(); it++)
+			if (it->ID == ID)
+				break;
+		return it;
+	}
+
+	void add(ReceivedSignal_type &newSignal) {
+		newSignal.power_mW = dBmTomW(newSignal.power_dBm);
+		signals.push_back(newSignal);
+		addToTotal(newSignal.power_mW);
+		signalSetChanged();
+	}
+
+	void erase(iterator it) {
+		addToTotal(-it->power_mW);
+		signals.erase(it);
+		signalSetChanged();
+	}
+
+	void clear() {
+		signals.clear();
+		signalSetChanged();
+	}
+
+	/* Total power in mW of all signals in the set, minus the excluded power
+	 * (e.g. the signal itself). Rounding can only make it slightly negative,
+	 * which is returned as zero; the periodic re-sum keeps any drift small.
+	 */
+	double totalPower_mW(double excluded_mW = 0.0) {
+		double power = (total_mW - compensation_mW) - excluded_mW;
+		return (power < 0.0) ? 0.0 : power;
+	}
 };
 
 struct TotalPowerReceived_type {
 	double power_dBm;	// in dBm
+	double power_mW;	// the same power in mW
 	simtime_t startTime;
+	double integral;	// integral of power (mW*sec) from the oldest element up to startTime
+};
+
+/* History of the total received power, kept in a ring buffer that only
+ * grows (doubling its size) if more changes than its size happen within
+ * one RSSI integration time. Every element also holds the running integral
+ * of power up to its start, so the average power over any window is the
+ * difference of two integrals. Elements that end before the window are
+ * dropped as new ones are added, so the buffer only holds the changes within
+ * one window and a read is O(1) amortised.
+ */
+class TotalPowerHistory {
+ private:
+	vector<TotalPowerReceived_type> buffer;
+	int oldest;
+	int count;
+
+	TotalPowerReceived_type &element(int i) {
+		return buffer[(oldest + i) & (buffer.size() - 1)];
+	}
+
+	void grow() {
+		vector<TotalPowerReceived_type> larger(buffer.size() * 2);
+		for (int i = 0; i < count; i++)
+			larger[i] = element(i);
+		buffer.swap(larger);
+		oldest = 0;
+	}
+
+	// drop the elements that end before limitTime, keeping at least one
+	void trim(simtime_t limitTime) {
+		if (count < 2 || element(1).startTime > limitTime)
+			return;
+		do {
+			oldest = (oldest + 1) & (buffer.size() - 1);
+			count--;
+		} while (count > 1 && element(1).startTime <= limitTime);
+		// rebase the remaining integrals, so they do not lose precision as they grow
+		double base = element(0).integral;
+		for (int i = 0; i < count; i++)
+			element(i).integral -= base;
+	}
+
+ public:
+	TotalPowerHistory(): buffer(POWER_HISTORY_INITIAL_SIZE), oldest(0), count(0) {}
+	bool empty() { return count == 0; }
+	void clear() { oldest = 0; count = 0; }
+	TotalPowerReceived_type &latest() { return element(count - 1); }
+
+	// window is the longest time average_mW() will be asked for
+	void add(double power_dBm, simtime_t startTime, double window) {
+		trim(startTime - window);
+		if (count == (int)buffer.size())
+			grow();
+		TotalPowerReceived_type &newElement = element(count);
+		if (count == 0)
+			newElement.integral = 0.0;
+		else
+			newElement.integral = latest().integral +
+				latest().power_mW * SIMTIME_DBL(startTime - latest().startTime);
+		newElement.power_dBm = power_dBm;
+		newElement.power_mW = dBmTomW(power_dBm);
+		newElement.startTime = startTime;
+		count++;
+	}
+
+	/* Average power in mW over the window [now - window, now]. Returns
+	 * false if the history does not reach back to the start of the window
+	 */
+	bool average_mW(simtime_t now, double window, double &average) {
+		if (count == 0)
+			return false;
+		simtime_t limitTime = now - window;
+		trim(limitTime);
+		if (element(0).startTime > limitTime)
+			return false;
+
+		double integralNow = latest().integral + latest().power_mW * SIMTIME_DBL(now - latest().startTime);
+		double integralLimit = element(0).integral + element(0).power_mW * SIMTIME_DBL(limitTime - element(0).startTime);
+		average = (integralNow - integralLimit) / window;
+		return true;
+	}
+
+	/* Find the first time after now at which the average power over the window
+	 * reaches threshold_mW, assuming the latest power stays unchanged. Returns
+	 * false if there is no such time, or if the average is already at or above
+	 * the threshold (or not valid) now. As time advances, the window gains the
+	 * latest power and loses the power of the element at its start, so the
+	 * average changes linearly while the start of the window crosses one
+	 * element. The elements are walked in order and the crossing is solved
+	 * exactly within the first segment that reaches the threshold. After a
+	 * full window the average equals the latest power, so the walk ends there.
+	 */
+	bool crossingTime(simtime_t now, double window, double threshold_mW, simtime_t &crossing) {
+		if (count == 0)
+			return false;
+		if (window <= 0) {
+			// the naive model: RSSI is the current power, it crosses now or never
+			if (latest().power_mW < threshold_mW || (count > 1 && element(count - 2).power_mW >= threshold_mW))
+				return false;
+			crossing = now;
+			return true;
+		}
+
+		double average;
+		if (!average_mW(now, window, average) || average >= threshold_mW)
+			return false;
+
+		double latestPower = latest().power_mW;
+		simtime_t t = now;
+		simtime_t limitTime = now - window;
+		for (int i = 0; i < count - 1; i++) {
+			// the start of the window moves through element i until the next element starts
+			double segment = SIMTIME_DBL(element(i + 1).startTime - limitTime);
+			double slope = (latestPower - element(i).power_mW) / window;
+			if (slope > 0 && average + slope * segment >= threshold_mW) {
+				crossing = t + (threshold_mW - average) / slope;
+				return true;
+			}
+			average += slope * segment;
+			t += segment;
+			limitTime = element(i + 1).startTime;
+		}
+		// the average reaches the latest power at the end of the walk, this
+		// catches a latest power equal to the threshold despite rounding
+		if (latestPower >= threshold_mW) {
+			crossing = t;
+			return true;
+		}
+		return false;
+	}
 };
 
 struct TransitionElement {
@@ -97,6 +404,10 @@ struct SleepLevel_type {
 	double power;
 	TransitionElement transitionUp;
 	TransitionElement transitionDown;
+	// the whole way up from this level to the first sleep level, and down
+	// from the first sleep level to this one. Power is averaged over the delay
+	TransitionElement toFirstLevel;
+	TransitionElement fromFirstLevel;
 };
 
 struct TxLevel_type {
@@ -104,11 +415,37 @@ struct TxLevel_type {
 	double txPowerConsumed;	// in mW
 };
 
+struct ChannelRejectionElement {
+	double offset;		// in MHz
+	double rejection;	// in dB
+};
+
 struct CustomModulationElement {
 	float SNR;
 	float BER;
 };
 
+/* Everything read from a radio parameters file, with the tables derived from
+ * it. Radios using the same file share one profile, which is parsed once per
+ * process and never modified afterwards (see Radio::loadRadioProfile)
+ */
+struct RadioProfile {
+	vector<TxLevel_type> TxLevelList;
+	vector<RXmode_type> RXmodeList;
+	vector<SleepLevel_type> sleepLevelList;
+	TransitionElement transition[3][3];
+
+	// if a custom modulation is defined in one of the RX modes this variable
+	// will hold the info. Only ONE custom modulation is currently supported
+	vector<CustomModulationElement> customModulation;
+	// uniform index over the SNR range of customModulation. Element i holds the
+	// last curve point with SNR not above customModulation[0].SNR + i * customModulationStep
+	vector<int> customModulationIndex;
+	double customModulationStep;
+
+	RadioProfile():customModulationStep(0) {}
+};
+
 enum CCA_result {
 	CLEAR = 1,
 	BUSY = 0,
@@ -135,52 +472,130 @@ struct PktBreakdown {
 			RxFailedModulation(0), RxFailedNoRxState(0), bufferOverflow(0) { }
 };
 
+/* A train of frames sent back to back as one transmission (burst TX).
+ * The train is encapsulated in the signal end message in place of a single
+ * MacPacket, and owns its frames. The length on air of each frame is kept,
+ * so receivers can find the frame boundaries within the signal.
+ */
+class RadioFrameTrain: public cPacket {
+ private:
+	vector<MacPacket*> frames;
+	vector<int> frameByteLength;
+
+	void copyFrames(const RadioFrameTrain &other) {
+		for (int i = 0; i < (int)other.frames.size(); i++) {
+			MacPacket *frame = NULL;
+			if (other.frames[i] != NULL) {
+				frame = other.frames[i]->dup();
+				take(frame);
+			}
+			frames.push_back(frame);
+		}
+		frameByteLength = other.frameByteLength;
+	}
+
+	void deleteFrames() {
+		for (int i = 0; i < (int)frames.size(); i++)
+			if (frames[i] != NULL)
+				dropAndDelete(frames[i]);
+		frames.clear();
+		frameByteLength.clear();
+	}
+
+ public:
+	RadioFrameTrain(const char *name = NULL): cPacket(name) {}
+	RadioFrameTrain(const RadioFrameTrain &other): cPacket(other) { copyFrames(other); }
+	~RadioFrameTrain() { deleteFrames(); }
+
+	RadioFrameTrain &operator=(const RadioFrameTrain &other) {
+		if (this == &other)
+			return *this;
+		cPacket::operator=(other);
+		deleteFrames();
+		copyFrames(other);
+		return *this;
+	}
+
+	virtual RadioFrameTrain *dup() const { return new RadioFrameTrain(*this); }
+
+	// add a frame at the end of the train, byteLength is its length on air
+	void addFrame(MacPacket *frame, int byteLength) {
+		take(frame);
+		frames.push_back(frame);
+		frameByteLength.push_back(byteLength);
+		addByteLength(byteLength);
+	}
+
+	int getNumOfFrames() const { return frames.size(); }
+	int getFrameByteLength(int index) const { return frameByteLength[index]; }
+
+	// the caller becomes the owner of the frame
+	MacPacket *removeFrame(int index) {
+		MacPacket *frame = frames[index];
+		if (frame != NULL) {
+			drop(frame);
+			frames[index] = NULL;
+		}
+		return frame;
+	}
+};
+
 class Radio: public CastaliaModule {
  private:
 
 	/* class member variables that are derived from module parameters
 	 * (either in RadioParametersFile or .ini file
 	 */
-	list<TxLevel_type> TxLevelList;
-	list<RXmode_type> RXmodeList;
-	list<SleepLevel_type> sleepLevelList;
-	TransitionElement transition[3][3];
+	RadioProfile *profile;	// shared with all radios using the same parameters file
 	int symbolsForRSSI;
 
 	double carrierFreq;
-	list<TxLevel_type>::iterator TxLevel;
-	list<RXmode_type>::iterator RXmode;
-	list<SleepLevel_type>::iterator sleepLevel;
+	// adjacent channel rejection mask, sorted by offset
+	vector<ChannelRejectionElement> channelRejectionMask;
+	vector<TxLevel_type>::iterator TxLevel;
+	vector<RXmode_type>::iterator RXmode;
+	vector<SleepLevel_type>::iterator sleepLevel;
 	BasicState_type state;
 
-	// if a custom modulation is defined in one of the RX modes this variable
-	// will hold the info. Only ONE custom modulation is currently supported
-	vector<CustomModulationElement> customModulation;
+	bool customModulationInterpolation;
 
 	double CCAthreshold;
 	bool carrierSenseInterruptEnabled;
 	CollisionModel_type collisionModel;
+	double captureThreshold;	// in dB, used by the complex interference model
+	bool deferredBitErrors;		// bit errors decided from SINR segments at the end of signals
 	Encoding_type encoding;
 	int maxPhyFrameSize;
 	int PhyFrameOverhead;
 	int bufferSize;		//in kbytes
+	bool burstTx;		// send all buffered frames as one train
 
 	/* class member variables used internally */
 	int self;		// the node's ID. Can be considered as a full MAC address
 
 	queue<MacPacket*> radioBuffer;
 
-	// a list of signals curently being received
-	list<ReceivedSignal_type> receivedSignals;
+	// a set of signals curently being received
+	ReceivedSignalSet receivedSignals;
 	// last time the above list changed
 	simtime_t timeOfLastSignalChange;
+	// SINR segments of the received signals (deferred bit errors)
+	InterferenceSegmentArena interferenceSegments;
+	// probability of 0 .. maxErrorsAllowed bit errors, scratch space for segmentBitErrors()
+	vector<double> errorDistribution;
+	// the signal the receiver is locked on (complex interference model), -1 if none
+	int capturedSignalID;
 
 	// a history of recent changes in total received power to help calculate RSSI
-	list<TotalPowerReceived_type> totalPowerReceived;
+	TotalPowerHistory totalPowerReceived;
 
 	// a pointer to the object of the Radio Module (used for direct method calls)
 	ResourceManager *resMgrModule;
 
+	// a pointer to the wireless channel module, used to read the aggregate weak
+	// interference in our cell. NULL if the channel is not a WirelessChannel
+	WirelessChannel *wirelessChannelModule;
+
 	int changingToState;	// indicates that the Radio is in the middle of changing from one state (A)
 							// to another (B). It also holds the value for state B
 
@@ -189,11 +604,16 @@ class Radio: public CastaliaModule {
 
 	// pointer to message that carries a future carrier sense interrupt
 	RadioControlMessage *CSinterruptMsg;
-	simtime_t latestCSinterruptTime;
 
-	// pointer to self message to complete state transition
+	// self message to complete state transition, allocated once and
+	// rescheduled. A transition is ongoing while it is scheduled
 	cMessage *stateTransitionMsg;
 
+	// self message to continue transmitting, and self command to leave TX
+	// when the buffer is empty. Both allocated once and rescheduled
+	cMessage *continueTxMsg;
+	RadioControlCommand *leaveTxCommand;
+
 	// what state to enter after TX
 	BasicState_type stateAfterTX;
 
@@ -206,36 +626,61 @@ class Radio: public CastaliaModule {
 	virtual void handleMessage(cMessage * msg);
 	virtual void finishSpecific();
 	void readIniFileParameters(void);
-	void parseRadioParameterFile(const char *);
+	void loadRadioProfile(const char *);
+	void parseRadioParameterFile(const char *, const string &);
+	void buildSleepLevelTransitions();
 
 	void updateTotalPowerReceived();
 	void updateTotalPowerReceived(double newSignalPower);
-	void updateTotalPowerReceived(list<ReceivedSignal_type>::iterator endingSignal);
-	void updateInterference(list<ReceivedSignal_type>::iterator it1, WirelessChannelSignalBegin * wcMsg);
-	void updateInterference(list<ReceivedSignal_type>::iterator it1, list<ReceivedSignal_type>::iterator endingSignal);
+	void updateTotalPowerReceived(ReceivedSignalSet::iterator endingSignal);
+	void updateInterference(ReceivedSignalSet::iterator it1, WirelessChannelSignalBegin * wcMsg);
+	void updateInterference(ReceivedSignalSet::iterator it1, ReceivedSignalSet::iterator endingSignal);
+	void updateBitErrors(ReceivedSignalSet::iterator it1);
+	int segmentBitErrors(int &, int &, int, int);
+	int signalBitErrors(ReceivedSignal_type &);
+	bool frameReceived(ReceivedSignal_type &, int);
+	void passToMac(MacPacket *, ReceivedSignal_type &);
+	void receiveFrameTrain(ReceivedSignal_type &, WirelessChannelSignalEnd *);
+	void captureSignal(ReceivedSignal_type &);
+	void clearReceivedSignals();
 
 	void completeStateTransition();
 	void delayStateTransition(simtime_t);
+	void scheduleLeaveTx(BasicState_type);
 	void handleRadioControlCommand(RadioControlCommand *);
 	double popAndSendToWirelessChannel();
 	void updatePossibleCSinterrupt();
-	double SNR2BER(double SNR);
+	double currentNoiseFloor();
+	void parseChannelRejectionMask(const char *);
+	double channelRejection(double);
+	void registerCarrierFreq();
+	double addNoiseFloor_dBm(double);
+	double SNR2BER(RXmode_type &, double SNR);
+	void lookupBER(double, double &, double &);
+	void buildBERTable(RXmode_type &);
+	void buildCustomModulationIndex();
+	double customModulationBER(double SNR);
 	int bitErrors(double, int, int);
 	int maxErrorsAllowed(Encoding_type) { return 0; }
 	int parseInt(const char *, int *);
 	int parseFloat(const char *, double *);
 	Modulation_type parseModulationType(const char *);
 	Encoding_type parseEncodingType(const char *);
-	list<RXmode_type>::iterator parseRxMode(string);
-	list<TxLevel_type>::iterator parseTxLevel(string);
-	list<TxLevel_type>::iterator parseTxLevel(double);
-	list<SleepLevel_type>::iterator parseSleepLevel(string);
+	vector<RXmode_type>::iterator parseRxMode(string);
+	vector<TxLevel_type>::iterator parseTxLevel(string);
+	vector<TxLevel_type>::iterator parseTxLevel(double);
+	vector<SleepLevel_type>::iterator parseSleepLevel(string);
+	template <class T> typename vector<T>::iterator elementAtIndex(vector<T> &, int, const char *);
 
 	void ReceivedSignalDebug(const char *);
 
  public:
 	double readRSSI();
 	CCA_result isChannelClear();
+	void weakInterferenceChanged();
+	int getRxModeIndex(const char *);
+	int getTxLevelIndex(double);
+	int getSleepLevelIndex(const char *);
 };
 
 #endif				//_RADIOMODULE_H_
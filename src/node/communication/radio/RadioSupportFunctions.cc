@@ -14,6 +14,10 @@
 
 #define ERFINV_ERROR 100000.0
 
+#define POWER_TABLE_SIZE 1024	// interpolation points for dBm <-> mW conversions
+#define LOG2_10 3.32192809488736234787
+#define LOG10_2 0.30102999566398119521
+
 /* Approximates the addition of 2 signals expressed in dBm.
  * Value returned in dBm
  */
@@ -158,6 +162,60 @@ float dBToRatio(float dB)
 	return 1.0;
 }
 
+/* Fast and precise conversions between dBm and mW, used by the radio to
+ * keep power totals in mW and convert to dBm only when needed. Both use
+ * a table over one octave with linear interpolation; the octave itself
+ * is handled by ldexp/frexp. The relative error of dBmTomW is below 1e-7
+ * and the error of mWTodBm is below 1e-6 dB.
+ */
+double dBmTomW(double dBm)
+{
+	// pow2_array[i] = 2^(i/POWER_TABLE_SIZE)
+	static double pow2_array[POWER_TABLE_SIZE + 1];
+	static bool initialized = false;
+	if (!initialized) {
+		for (int i = 0; i <= POWER_TABLE_SIZE; i++)
+			pow2_array[i] = pow(2.0, (double)i / POWER_TABLE_SIZE);
+		initialized = true;
+	}
+
+	// 10^(dBm/10) = 2^(dBm/10 * log2(10)) = 2^exponent * 2^fraction
+	double y = dBm * (LOG2_10 / 10.0);
+	double exponent = floor(y);
+	double position = (y - exponent) * POWER_TABLE_SIZE;
+	int index = (int)position;
+	if (index >= POWER_TABLE_SIZE)
+		index = POWER_TABLE_SIZE - 1;
+	double a = position - index;
+	return ldexp((1 - a) * pow2_array[index] + a * pow2_array[index + 1], (int)exponent);
+}
+
+double mWTodBm(double mW)
+{
+	// log2_array[i] = log2(0.5 + 0.5*i/POWER_TABLE_SIZE)
+	static double log2_array[POWER_TABLE_SIZE + 1];
+	static bool initialized = false;
+	if (!initialized) {
+		for (int i = 0; i <= POWER_TABLE_SIZE; i++)
+			log2_array[i] = log(0.5 + 0.5 * i / POWER_TABLE_SIZE) / log(2.0);
+		initialized = true;
+	}
+
+	if (mW <= 0.0)
+		return -200.0;	// practically -infinite
+
+	// mW = mantissa * 2^exponent, mantissa in [0.5, 1)
+	int exponent;
+	double mantissa = frexp(mW, &exponent);
+	double position = (mantissa - 0.5) * 2.0 * POWER_TABLE_SIZE;
+	int index = (int)position;
+	if (index >= POWER_TABLE_SIZE)
+		index = POWER_TABLE_SIZE - 1;
+	double a = position - index;
+	double log2mW = exponent + (1 - a) * log2_array[index] + a * log2_array[index + 1];
+	return 10.0 * LOG10_2 * log2mW;
+}
+
 float erfInv(float y)
 {
 	static float a[] = { 0.0, 0.886226899, -1.645349621, 0.914624893, -0.140543331 };
@@ -315,6 +373,18 @@ RadioControlCommand *createRadioCommand(RadioControlCommand_type kind, BasicStat
 	return cmd;
 }
 
+RadioControlCommand *createRadioCommandWithIndex(RadioControlCommand_type kind, int index)
+{
+	if (kind != SET_MODE && kind != SET_TX_OUTPUT && kind != SET_SLEEP_LEVEL)
+		opp_error("incorrect usage of createRadioCommandWithIndex, index argument is only compatible with SET_MODE, SET_TX_OUTPUT or SET_SLEEP_LEVEL");
+	if (index < 0)
+		opp_error("incorrect usage of createRadioCommandWithIndex, negative index");
+	RadioControlCommand *cmd = new RadioControlCommand("Radio control command", RADIO_CONTROL_COMMAND);
+	cmd->setRadioControlCommandKind(kind);
+	cmd->setIndex(index);
+	return cmd;
+}
+
 RadioControlCommand *createRadioCommand(RadioControlCommand_type kind)
 {
 	if (kind != SET_CS_INTERRUPT_ON && kind != SET_CS_INTERRUPT_OFF)
@@ -25,6 +25,10 @@ float ratioTodB(float a);
 
 float dBToRatio(float a);
 
+double dBmTomW(double dBm);
+
+double mWTodBm(double mW);
+
 float erfInv(float y);
 
 float erfcInv(float y);
@@ -39,5 +43,6 @@ RadioControlCommand *createRadioCommand(RadioControlCommand_type, double);
 RadioControlCommand *createRadioCommand(RadioControlCommand_type, const char *);
 RadioControlCommand *createRadioCommand(RadioControlCommand_type, BasicState_type);
 RadioControlCommand *createRadioCommand(RadioControlCommand_type);
+RadioControlCommand *createRadioCommandWithIndex(RadioControlCommand_type, int);
 
 #endif				/*SUPPORTFUNCTIONS_H_ */
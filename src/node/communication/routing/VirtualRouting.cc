@@ -108,12 +108,12 @@ void VirtualRouting::handleMessage(cMessage * msg)
 			ApplicationPacket *appPacket = check_and_cast <ApplicationPacket*>(msg);
 			if (maxNetFrameSize > 0 && maxNetFrameSize < appPacket->getByteLength() + netDataFrameOverhead)
 			{
-				trace() << "Oversized packet dropped. Size:" << appPacket->getByteLength() <<
+				TRACE << "Oversized packet dropped. Size:" << appPacket->getByteLength() <<
 				    ", Network layer overhead:" << netDataFrameOverhead <<
 				    ", max Network packet size:" << maxNetFrameSize;
 				break;
 			}
-			trace() << "Received [" << appPacket->getName() << "] from application layer";
+			TRACE << "Received [" << appPacket->getName() << "] from application layer";
 
 			/* Control is now passed to a specific routing protocol by calling fromApplicationLayer()
 			 * Notice that after the call we RETURN (not BREAK) so that the packet is not deleted.
@@ -128,7 +128,7 @@ void VirtualRouting::handleMessage(cMessage * msg)
 		case NETWORK_LAYER_PACKET:
 		{
 			RoutingPacket *netPacket = check_and_cast <RoutingPacket*>(msg);
-			trace() << "Received [" << netPacket->getName() << "] from MAC layer";
+			TRACE << "Received [" << netPacket->getName() << "] from MAC layer";
 			NetMacInfoExchange_type info = netPacket->getNetMacInfoExchange();
 
 			/* Control is now passed to a specific routing protocol by calling fromMacLayer()
@@ -220,7 +220,7 @@ int VirtualRouting::bufferPacket(cPacket * rcvFrame)
 		return 0;
 	} else {
 		TXBuffer.push(rcvFrame);
-		trace() << "Packet buffered from application layer, buffer state: " <<
+		TRACE << "Packet buffered from application layer, buffer state: " <<
 				TXBuffer.size() << "/" << netBufferSize;
 		return 1;
 	}
@@ -32,8 +32,17 @@ void FloodRouting::startup() {
 	snprintf(filename, 63, "Dev%s_RoutingLog", SELF_NETWORK_ADDRESS);
 	log = std::fopen(filename, "w+");
 
-	declareOutput(LOGDESC_TX);
-	declareOutput(LOGDESC_RX);
+	txOutput = declareOutput(LOGDESC_TX);
+	dataTxLabel = declareOutputLabel(txOutput, LOGDESC_DATATX);
+	otherTxLabel = declareOutputLabel(txOutput, LOGDESC_OTHRTX);
+	dataRelayLabel = declareOutputLabel(txOutput, LOGDESC_DATARE);
+	otherRelayLabel = declareOutputLabel(txOutput, LOGDESC_OTHRRE);
+
+	rxOutput = declareOutput(LOGDESC_RX);
+	dataRxLabel = declareOutputLabel(rxOutput, LOGDESC_DATARX);
+	otherRxLabel = declareOutputLabel(rxOutput, LOGDESC_OTHRRX);
+	discardRxLabel = declareOutputLabel(rxOutput, LOGDESC_DISCRX);
+	applRxLabel = declareOutputLabel(rxOutput, LOGDESC_APPLRX);
 }
 
 
@@ -71,7 +80,7 @@ void FloodRouting::fromApplicationLayer(cPacket* pkt, const char *destination) {
 		// Unicast to first relay using our MAC cache
 		toMacLayer(netPacket, addressTable[dest]);
 		SEQ++;
-		collectOutput(LOGDESC_TX, LOGDESC_DATATX);
+		collectOutput(txOutput, -1, dataTxLabel);
 
 		std::fprintf(log, "Data \"%s\" sent to device %s\n\n", packetName, dest.c_str());
 	}
@@ -97,7 +106,7 @@ void FloodRouting::fromApplicationLayer(cPacket* pkt, const char *destination) {
 		encapsulatePacket(netPacket, pkt);
 		toMacLayer(netPacket, BROADCAST_MAC_ADDRESS);
 		SEQ++;
-		collectOutput(LOGDESC_TX, LOGDESC_OTHRTX);
+		collectOutput(txOutput, -1, otherTxLabel);
 
 		std::fprintf(log, "Request \"%s\" broadcast to MAC layer\n\n", packetName);
 	}
@@ -130,7 +139,7 @@ void FloodRouting::fromMacLayer(cPacket* pkt, int srcMacAddress, double rssi, do
 	// Check source: there is no point in reading a packet we transmitted ourselves
 	if (std::memcmp(netPacket->getSource(), SELF_NETWORK_ADDRESS, std::strlen(netPacket->getSource())) == 0) {
 		std::fprintf(log, "This request came from us, discarding\n\n");
-		collectOutput(LOGDESC_RX, LOGDESC_DISCRX);
+		collectOutput(rxOutput, -1, discardRxLabel);
 		return;
 	}
 
@@ -143,7 +152,7 @@ void FloodRouting::fromMacLayer(cPacket* pkt, int srcMacAddress, double rssi, do
 		if (SEQn <= SEQm) {
 			// This packet is old, discard it
 			std::fprintf(log, "This packet has an older SEQ - tracked: %d, packet: %d - discarding\n\n", SEQm, SEQn);
-			collectOutput(LOGDESC_RX, LOGDESC_DISCRX);
+			collectOutput(rxOutput, -1, discardRxLabel);
 			return;
 		}
 		else {
@@ -164,7 +173,7 @@ void FloodRouting::fromMacLayer(cPacket* pkt, int srcMacAddress, double rssi, do
 	switch (netPacket->getType()) {
 
 	case PacketType::DATA:
-		collectOutput(LOGDESC_RX, LOGDESC_DATARX);
+		collectOutput(rxOutput, -1, dataRxLabel);
 	
 		// This is a regular packet, see if it reached the destination
 		if (destination.compare(SELF_NETWORK_ADDRESS) == 0) {
@@ -172,7 +181,7 @@ void FloodRouting::fromMacLayer(cPacket* pkt, int srcMacAddress, double rssi, do
 			// The packet has arrived, deliver it to the app layer
 			std::fprintf(log, "Data packet reached destination, delivering to application layer\n\n");
 			toApplicationLayer(decapsulatePacket(pkt));
-			collectOutput(LOGDESC_RX, LOGDESC_APPLRX);
+			collectOutput(rxOutput, -1, applRxLabel);
 			
 		}
 		else {
@@ -193,14 +202,14 @@ void FloodRouting::fromMacLayer(cPacket* pkt, int srcMacAddress, double rssi, do
 			}
 			
 			toMacLayer(p, addressTable[dest]);
-			collectOutput(LOGDESC_TX, LOGDESC_DATARE);
+			collectOutput(txOutput, -1, dataRelayLabel);
 			std::fprintf(log, "Data \"%s\" sent to device %s\n\n", p->getName(), dest.c_str());
 		}
 
 		break;
 
 	case PacketType::RREQ:
-		collectOutput(LOGDESC_RX, LOGDESC_OTHRRX);
+		collectOutput(rxOutput, -1, otherRxLabel);
 
 		// This is a route request, see if it reached the destination
 		if (destination.compare(SELF_NETWORK_ADDRESS)) {
@@ -214,7 +223,7 @@ void FloodRouting::fromMacLayer(cPacket* pkt, int srcMacAddress, double rssi, do
 			p->setIndex(p->getIndex() + 1);
 			
 			toMacLayer(p, BROADCAST_MAC_ADDRESS);
-			collectOutput(LOGDESC_TX, LOGDESC_OTHRRE);
+			collectOutput(txOutput, -1, otherRelayLabel);
 			std::fprintf(log, "Request \"%s\" broadcast to MAC layer\n\n", p->getName());
 		}
 		else {
@@ -227,7 +236,7 @@ void FloodRouting::fromMacLayer(cPacket* pkt, int srcMacAddress, double rssi, do
 				// AP190808: If we're here, then we've already made a route to here.
 				// 			 For now, ignore the new request, may consider different strategies in the future
 				std::fprintf(log, "Request ignored, we already have a route\n\n");
-				collectOutput(LOGDESC_RX, LOGDESC_DISCRX);
+				collectOutput(rxOutput, -1, discardRxLabel);
 				return;
 			}
 			catch (const std::out_of_range& e) {
@@ -249,7 +258,7 @@ void FloodRouting::fromMacLayer(cPacket* pkt, int srcMacAddress, double rssi, do
 				// Deliver the data to the application layer - keep its name
 				std::fprintf(log, "Unpacking and delivering to application\n");
 				toApplicationLayer(decapsulatePacket(pkt));
-				collectOutput(LOGDESC_RX, LOGDESC_APPLRX);
+				collectOutput(rxOutput, -1, applRxLabel);
 
 				// Finally, construct the corresponding RREP to send back to the source
 				packetName[2] = 'P';
@@ -270,7 +279,7 @@ void FloodRouting::fromMacLayer(cPacket* pkt, int srcMacAddress, double rssi, do
 
 				toMacLayer(netPacket2, addressTable[netPacket2->getRoute(netPacket2->getIndex())]);
 				SEQ++;
-				collectOutput(LOGDESC_TX, LOGDESC_OTHRRE);
+				collectOutput(txOutput, -1, otherRelayLabel);
 
 				std::fprintf(log, "Reply \"%s\" sent to device %s\n\n", packetName, netPacket2->getRoute(netPacket2->getIndex()));
 			}
@@ -279,7 +288,7 @@ void FloodRouting::fromMacLayer(cPacket* pkt, int srcMacAddress, double rssi, do
 		break;
 
 	case PacketType::RREP:
-		collectOutput(LOGDESC_RX, LOGDESC_OTHRRX);
+		collectOutput(rxOutput, -1, otherRxLabel);
 
 		// This is a route reply, see if it reached the destination
 		if (destination.compare(SELF_NETWORK_ADDRESS)) {
@@ -300,7 +309,7 @@ void FloodRouting::fromMacLayer(cPacket* pkt, int srcMacAddress, double rssi, do
 			}
 			
 			toMacLayer(p, addressTable[dest]);
-			collectOutput(LOGDESC_TX, LOGDESC_OTHRRE);
+			collectOutput(txOutput, -1, otherRelayLabel);
 			std::fprintf(log, "Reply \"%s\" sent to device %s\n\n", packetName, dest.c_str());
 		}
 		else {
@@ -312,7 +321,7 @@ void FloodRouting::fromMacLayer(cPacket* pkt, int srcMacAddress, double rssi, do
 				// AP190808: If we're here, then we've already made a route to here.
 				// 			 For now, ignore the new request, may consider different strategies in the future
 				std::fprintf(log, "Reply ignored, we already have a route\n\n");
-				collectOutput(LOGDESC_RX, LOGDESC_DISCRX);
+				collectOutput(rxOutput, -1, discardRxLabel);
 			}
 			catch (const std::out_of_range& e) {
 
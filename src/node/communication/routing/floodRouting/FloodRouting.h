@@ -27,6 +27,9 @@ private:
 	std::map<std::string, std::list<std::string>> routeTable;	/**< @brief The routing table, used only by the sink */
 	std::map<std::string, int> SEQTable;						/**< @brief A table for keeping SEQ pointers for all devices */
 	int SEQ = 0;
+	int txOutput, rxOutput;										/**< @brief Handles of the packet breakdown outputs */
+	int dataTxLabel, otherTxLabel, dataRelayLabel, otherRelayLabel;	/**< @brief Label ids of the TX packet breakdown */
+	int dataRxLabel, otherRxLabel, discardRxLabel, applRxLabel;	/**< @brief Label ids of the RX packet breakdown */
 
 protected:
 
@@ -76,12 +76,12 @@ void MultipathRingsRouting::timerFiredCallback(int index)
 		if (!isConnected) {
 			isConnected = true;
 			sendControlMessage(MPRINGS_CONNECTED_TO_TREE);
-			trace() << "Connected to " << currentSinkID << " at level " << currentLevel;
+			TRACE << "Connected to " << currentSinkID << " at level " << currentLevel;
 			if (!TXBuffer.empty())
 				processBufferedPacket();
 		} else {
 			sendControlMessage(MPRINGS_TREE_LEVEL_UPDATED);
-			trace() << "Reconnected to " << currentSinkID << " at level " << currentLevel;
+			TRACE << "Reconnected to " << currentSinkID << " at level " << currentLevel;
 		}
 		sendTopologySetupPacket();
 	}
@@ -170,7 +170,7 @@ void MultipathRingsRouting::fromMacLayer(cPacket * pkt, int macAddress, double r
 						if (isNotDuplicatePacket(pkt))
 							toApplicationLayer(decapsulatePacket(pkt));
 						else
-							trace() << "Discarding duplicate packet from node " << src;
+							TRACE << "Discarding duplicate packet from node " << src;
 					} else if (sinkID == currentSinkID) {
 						// We want to rebroadcast this packet since we are not its destination
 						// For this, a copy of the packet is created and sender level field is 
@@ -187,7 +187,7 @@ void MultipathRingsRouting::fromMacLayer(cPacket * pkt, int macAddress, double r
 					if (isNotDuplicatePacket(pkt))
 						toApplicationLayer(decapsulatePacket(pkt));
 					else
-						trace() << "Discarding duplicate packet from node " << src;
+						TRACE << "Discarding duplicate packet from node " << src;
 				}
 			}
 			break;
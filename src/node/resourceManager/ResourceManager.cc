@@ -11,6 +11,7 @@
  *******************************************************************************/
 
 #include "ResourceManager.h"
+#include "NetworkStatistics.h"
 
 Define_Module(ResourceManager);
 
@@ -43,6 +44,10 @@ void ResourceManager::initialize()
 	remainingEnergy = initialEnergy;
 	totalRamData = 0;
 	disabled = true;
+
+	self = getParentModule()->getIndex();
+	statistics = NetworkStatistics::getInstance();
+	statistics->reportEnergy(self, initialEnergy, remainingEnergy);
 }
 
 void ResourceManager::calculateEnergySpent()
@@ -83,15 +88,7 @@ void ResourceManager::handleMessage(cMessage * msg)
 
 		case RESOURCE_MANAGER_DRAW_POWER:{
 			ResourceManagerMessage *resMsg = check_and_cast<ResourceManagerMessage*>(msg);
-			int id = resMsg->getSenderModuleId();
-			double oldPower = storedPowerConsumptions[id];
-			trace() << "New power consumption, id = " << id << ", oldPower = " << 
-					currentNodePower << ", newPower = " << 
-					currentNodePower - oldPower + resMsg->getPowerConsumed();
-			if (!disabled)
-				calculateEnergySpent();
-			currentNodePower = currentNodePower - oldPower + resMsg->getPowerConsumed();
-			storedPowerConsumptions[id] = resMsg->getPowerConsumed();
+			updatePowerConsumption(resMsg->getSenderModuleId(), resMsg->getPowerConsumed());
 			break;
 		}
 
@@ -102,6 +99,21 @@ void ResourceManager::handleMessage(cMessage * msg)
 	delete msg;
 }
 
+/* Record a new power drawn by the module with the given id. Energy spent
+ * with the old power is accounted for first.
+ */
+void ResourceManager::updatePowerConsumption(int id, double power)
+{
+	double oldPower = storedPowerConsumptions[id];
+	trace() << "New power consumption, id = " << id << ", oldPower = " <<
+			currentNodePower << ", newPower = " <<
+			currentNodePower - oldPower + power;
+	if (!disabled)
+		calculateEnergySpent();
+	currentNodePower = currentNodePower - oldPower + power;
+	storedPowerConsumptions[id] = power;
+}
+
 void ResourceManager::finishSpecific()
 {
 	calculateEnergySpent();
@@ -110,35 +122,28 @@ void ResourceManager::finishSpecific()
 	declareOutput("Remaining Energy");
 	collectOutput("Remaining Energy", "", remainingEnergy);
 
-	if (getParentModule()->getIndex() == 0) {
-		cTopology *topo;	// temp variable to access energy spent by other nodes
-		topo = new cTopology("topo");
-		topo->extractByNedTypeName(cStringTokenizer("node.Node").asVector());
-
-		double minLifetime = estimateLifetime();
-		for (int i = 1; i < topo->getNumNodes(); i++) {
-			ResourceManager *resMng = dynamic_cast<ResourceManager*>
-				(topo->getNode(i)->getModule()->getSubmodule("ResourceManager"));
-			if (minLifetime > resMng->estimateLifetime()) 
-				minLifetime = resMng->estimateLifetime();
-		}
+	double lifetime = self == 0 ? statistics->getNetworkLifetime() : -1;
+	if (lifetime >= 0) {
 		declareOutput("Estimated network lifetime (days)");
-		collectOutput("Estimated network lifetime (days)", "", minLifetime);
-		delete(topo);
+		collectOutput("Estimated network lifetime (days)", "", lifetime);
 	}
 }
 
-double ResourceManager::estimateLifetime(void) 
-{
-	return ((initialEnergy * simTime().dbl()) / ((initialEnergy - remainingEnergy) * 86400.0));
-}
-
 double ResourceManager::getSpentEnergy(void)
 {
 	Enter_Method("getSpentEnergy()");
 	return (initialEnergy - remainingEnergy);
 }
 
+/* Direct method version of the RESOURCE_MANAGER_DRAW_POWER message, used
+ * by CastaliaModule::powerDrawn so that no message is created per change
+ */
+void ResourceManager::drawPower(int moduleId, double power)
+{
+	Enter_Method_Silent();
+	updatePowerConsumption(moduleId, power);
+}
+
 double ResourceManager::getCPUClockDrift(void)
 {
 	Enter_Method("getCPUClockDrift(void)");
@@ -162,6 +167,7 @@ void ResourceManager::consumeEnergy(double amount)
 		collectOutput("Dead Node", "time", SIMTIME_DBL(simTime()));
 	} else
 		remainingEnergy -= amount;
+	statistics->reportEnergy(self, initialEnergy, remainingEnergy);
 }
 
 void ResourceManager::destroyNode(void)
@@ -19,6 +19,8 @@
 
 using namespace std;
 
+class NetworkStatistics;
+
 enum ResoruceManagerTimers {
 	PERIODIC_ENERGY_CALCULATION = 1,
 };
@@ -45,17 +47,21 @@ class ResourceManager: public CastaliaModule {
 	cMessage *energyMsg;
 	bool disabled;
 
+	int self;	// the node's index
+	NetworkStatistics *statistics;
+
  protected:
 	virtual void initialize();
 	virtual void handleMessage(cMessage * msg);
 	virtual void finishSpecific();
 	void calculateEnergySpent();
+	void updatePowerConsumption(int, double);
 
  public:
 	double getCPUClockDrift(void);
+	void drawPower(int moduleId, double power);
 	void consumeEnergy(double amount);
 	double getSpentEnergy(void);
-	double estimateLifetime();
 	void destroyNode(void);
 	int RamStore(int numBytes);
 	void RamFree(int numBytes);
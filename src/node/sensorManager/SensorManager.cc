@@ -32,7 +32,7 @@ void SensorManager::initialize()
 		sensorLastValue.push_back(-1);
 		sensorlastSampleTime.push_back(-100000.0);
 
-		theBias = normal(0, sensorBiasSigma[i]);	// using rng generator --> "0" 
+		theBias = normal(0, params->sensorBiasSigma[i]);	// using rng generator --> "0" 
 		sensorBias.push_back(theBias);
 	}
 }
@@ -72,7 +72,7 @@ void SensorManager::handleMessage(cMessage * msg)
 
 			simtime_t currentTime = simTime();
 			simtime_t interval = currentTime - sensorlastSampleTime[sensorIndex];
-			int getNewSample = (interval < minSamplingIntervals[sensorIndex]) ? 0 : 1;
+			int getNewSample = (interval < params->minSamplingIntervals[sensorIndex]) ? 0 : 1;
 
 			if (getNewSample) {	//the last request for sample was more than minSamplingIntervals[sensorIndex] time ago
 				PhysicalProcessMessage *requestMsg =
@@ -84,7 +84,7 @@ void SensorManager::handleMessage(cMessage * msg)
 
 				// send the request to the physical process (using the appropriate 
 				// gate index for the respective sensor device )
-				send(requestMsg, "toNodeContainerModule", corrPhyProcess[sensorIndex]);
+				send(requestMsg, "toNodeContainerModule", params->corrPhyProcess[sensorIndex]);
 
 				// update the remaining energy of the node
 				// powerDrawn(pwrConsumptionPerDevice[sensorIndex]);
@@ -100,7 +100,7 @@ void SensorManager::handleMessage(cMessage * msg)
 				//readingMsg->setSensedValue(sensorLastValue[sensorIndex]);
 				//readingMsg->setSensorIndex(sensorIndex);
 				//send(readingMsg, "toApplicationModule"); //send the sensor reading to the Application module
-				rcvPacket->setSensorType(sensorTypes[sensorIndex].c_str());
+				rcvPacket->setSensorType(params->sensorTypes[sensorIndex].c_str());
 				rcvPacket->setSensedValue(sensorLastValue[sensorIndex]);
 				send(rcvPacket, "toApplicationModule");
 				return;
@@ -121,20 +121,20 @@ void SensorManager::handleMessage(cMessage * msg)
 
 			// add the sensor's Bias and the random noise 
 			theValue += sensorBias[sensorIndex];
-			theValue += normal(0, sensorNoiseSigma[sensorIndex], 1);
+			theValue += normal(0, params->sensorNoiseSigma[sensorIndex], 1);
 
 			// process the limitations of the sensing device (sensitivity, resoultion and saturation)
-			if (theValue < sensorSensitivity[sensorIndex])
-				theValue = sensorSensitivity[sensorIndex];
-			if (theValue > sensorSaturation[sensorIndex])
-				theValue = sensorSaturation[sensorIndex];
+			if (theValue < params->sensorSensitivity[sensorIndex])
+				theValue = params->sensorSensitivity[sensorIndex];
+			if (theValue > params->sensorSaturation[sensorIndex])
+				theValue = params->sensorSaturation[sensorIndex];
 
-			theValue = sensorResolution[sensorIndex] * lrint(theValue / sensorResolution[sensorIndex]);
+			theValue = params->sensorResolution[sensorIndex] * lrint(theValue / params->sensorResolution[sensorIndex]);
 			sensorLastValue[sensorIndex] = theValue;
 
 			SensorReadingMessage *readingMsg =
 					new SensorReadingMessage("sensor reading", SENSOR_READING_MESSAGE);
-			readingMsg->setSensorType(sensorTypes[sensorIndex].c_str());
+			readingMsg->setSensorType(params->sensorTypes[sensorIndex].c_str());
 			readingMsg->setSensedValue(theValue);
 			readingMsg->setSensorIndex(sensorIndex);
 
@@ -166,97 +166,122 @@ void SensorManager::handleMessage(cMessage * msg)
 	msg = NULL;		// safeguard
 }
 
+// the parameters parsed into SensorManagerParameters
+static const char *parsedParams[] = {
+	"corrPhyProcess", "pwrConsumptionPerDevice", "maxSampleRates", "sensorTypes",
+	"devicesBias", "devicesNoise", "devicesSensitivity", "devicesResolution",
+	"devicesSaturation", "numSensingDevices", NULL
+};
+
+/* Share the parsed parameters with all the sensor managers that have the same
+ * values of the parsed parameters, parsing them only if no other sensor
+ * manager did already
+ */
 void SensorManager::parseStringParams(void)
+{
+	string signature = parameterSignature(parsedParams);
+	params = SharedParameters<SensorManagerParameters>::find(signature);
+	if (params == NULL) {
+		SensorManagerParameters *parsed = new SensorManagerParameters();
+		parseStringParams(*parsed);
+		params = SharedParameters<SensorManagerParameters>::intern(signature, parsed);
+	}
+	totalSensors = params->totalSensors;
+
+	// the gates do not take part in the signature, check them for every module
+	if (gateSize("toNodeContainerModule") < totalSensors)
+		opp_error("\n[Sensor Device Manager]: The parameters of the sensor device manager are not initialized correctly in omnet.ini file.");
+}
+
+void SensorManager::parseStringParams(SensorManagerParameters &p)
 {
 	const char *parameterStr, *token;
 	simtime_t sampleInterval;
 
 	//get the physical process index that each sensor device is monitoring
-	corrPhyProcess.clear();
+	p.corrPhyProcess.clear();
 	parameterStr = par("corrPhyProcess");
 	cStringTokenizer phyTokenizer(parameterStr);
 	while ((token = phyTokenizer.nextToken()) != NULL)
-		corrPhyProcess.push_back(atoi(token));
+		p.corrPhyProcess.push_back(atoi(token));
 
 	//get the power consumption of each sensor device
-	pwrConsumptionPerDevice.clear();
+	p.pwrConsumptionPerDevice.clear();
 	parameterStr = par("pwrConsumptionPerDevice");
 	cStringTokenizer pwrTokenizer(parameterStr);
 	while ((token = pwrTokenizer.nextToken()) != NULL)
-		pwrConsumptionPerDevice.push_back(((double)atof(token)));  // the power consumption in mW
+		p.pwrConsumptionPerDevice.push_back(((double)atof(token)));  // the power consumption in mW
 
 	// get the max sample rate for each sensor device and calculate the minSamplingIntervals 
 	// (that is: every how many ms to request a sample from the physical process)
-	minSamplingIntervals.clear();
+	p.minSamplingIntervals.clear();
 	parameterStr = par("maxSampleRates");
 	cStringTokenizer ratesTokenizer(parameterStr);
 	while ((token = ratesTokenizer.nextToken()) != NULL) {
 		sampleInterval = (double)(1.0f / atof(token));
-		minSamplingIntervals.push_back(sampleInterval);
+		p.minSamplingIntervals.push_back(sampleInterval);
 	}
 
 	//get the type of each sensor device (just a description e.g.: light, temperature etc.)
-	sensorTypes.clear();
+	p.sensorTypes.clear();
 	parameterStr = par("sensorTypes");
 	cStringTokenizer typesTokenizer(parameterStr);
 	while ((token = typesTokenizer.nextToken()) != NULL) {
 		string sensorType(token);
-		sensorTypes.push_back(sensorType);
+		p.sensorTypes.push_back(sensorType);
 	}
 
 	// get the bias sigmas for each sensor device
-	sensorBiasSigma.clear();
+	p.sensorBiasSigma.clear();
 	parameterStr = par("devicesBias");
 	cStringTokenizer biasSigmaTokenizer(parameterStr);
 	while ((token = biasSigmaTokenizer.nextToken()) != NULL)
-		sensorBiasSigma.push_back((double)atof(token));
+		p.sensorBiasSigma.push_back((double)atof(token));
 
 	// get the bias sigmas for each sensor device
-	sensorNoiseSigma.clear();
+	p.sensorNoiseSigma.clear();
 	parameterStr = par("devicesNoise");
 	cStringTokenizer noiseSigmaTokenizer(parameterStr);
 	while ((token = noiseSigmaTokenizer.nextToken()) != NULL)
-		sensorNoiseSigma.push_back((double)atof(token));
+		p.sensorNoiseSigma.push_back((double)atof(token));
 
-	sensorSensitivity.clear();
+	p.sensorSensitivity.clear();
 	parameterStr = par("devicesSensitivity");
 	cStringTokenizer sensitivityTokenizer(parameterStr);
 	while ((token = sensitivityTokenizer.nextToken()) != NULL)
-		sensorSensitivity.push_back((double)atof(token));
+		p.sensorSensitivity.push_back((double)atof(token));
 
-	sensorResolution.clear();
+	p.sensorResolution.clear();
 	parameterStr = par("devicesResolution");
 	cStringTokenizer resolutionTokenizer(parameterStr);
 	while ((token = resolutionTokenizer.nextToken()) != NULL)
-		sensorResolution.push_back((double)atof(token));
+		p.sensorResolution.push_back((double)atof(token));
 
-	sensorSaturation.clear();
+	p.sensorSaturation.clear();
 	parameterStr = par("devicesSaturation");
 	cStringTokenizer saturationTokenizer(parameterStr);
 	while ((token = saturationTokenizer.nextToken()) != NULL)
-		sensorSaturation.push_back((double)atof(token));
-
-	totalSensors = par("numSensingDevices");
+		p.sensorSaturation.push_back((double)atof(token));
 
-	int totalPhyProcesses = gateSize("toNodeContainerModule");
+	p.totalSensors = par("numSensingDevices");
 
 	//check for malformed parameter string in the omnet.ini file
 	int aSz, bSz, cSz, dSz, eSz, fSz, mSz, rSz, sSz;
-	aSz = (int)pwrConsumptionPerDevice.size();
-	bSz = (int)minSamplingIntervals.size();
-	cSz = (int)sensorTypes.size();
-	dSz = (int)corrPhyProcess.size();
-	eSz = (int)sensorBiasSigma.size();
-	fSz = (int)sensorNoiseSigma.size();
-	mSz = (int)sensorSensitivity.size();
-	rSz = (int)sensorResolution.size();
-	sSz = (int)sensorSaturation.size();
-
-	if ((totalPhyProcesses < totalSensors) || (aSz != totalSensors)
-	    || (bSz != totalSensors) || (cSz != totalSensors)
-	    || (dSz != totalSensors) || (eSz != totalSensors)
-	    || (fSz != totalSensors) || (mSz != totalSensors)
-	    || (rSz != totalSensors) || (sSz != totalSensors))
+	aSz = (int)p.pwrConsumptionPerDevice.size();
+	bSz = (int)p.minSamplingIntervals.size();
+	cSz = (int)p.sensorTypes.size();
+	dSz = (int)p.corrPhyProcess.size();
+	eSz = (int)p.sensorBiasSigma.size();
+	fSz = (int)p.sensorNoiseSigma.size();
+	mSz = (int)p.sensorSensitivity.size();
+	rSz = (int)p.sensorResolution.size();
+	sSz = (int)p.sensorSaturation.size();
+
+	if ((aSz != p.totalSensors)
+	    || (bSz != p.totalSensors) || (cSz != p.totalSensors)
+	    || (dSz != p.totalSensors) || (eSz != p.totalSensors)
+	    || (fSz != p.totalSensors) || (mSz != p.totalSensors)
+	    || (rSz != p.totalSensors) || (sSz != p.totalSensors))
 		opp_error("\n[Sensor Device Manager]: The parameters of the sensor device manager are not initialized correctly in omnet.ini file.");
 }
 
@@ -267,6 +292,6 @@ double SensorManager::getSensorDeviceBias(int index)
 		trace() << "WARNING: Sensor index out of bound ( direct method call : getSensorDeviceBias() )";
 		return -1.0f;
 	} else
-		return sensorBiasSigma[index];
+		return params->sensorBiasSigma[index];
 }
 
@@ -21,10 +21,11 @@
 
 using namespace std;
 
-class SensorManager: public CastaliaModule {
- private:
-	/*--- The .ned file's parameters ---*/
-	bool printDebugInfo;
+/* The .ned file's parameters, parsed once and shared by all the
+ * sensor managers with the same configuration
+ */
+struct SensorManagerParameters {
+	int totalSensors;
 	vector<int> corrPhyProcess;
 	vector<double> pwrConsumptionPerDevice;
 	vector<simtime_t> minSamplingIntervals;
@@ -34,6 +35,13 @@ class SensorManager: public CastaliaModule {
 	vector<double> sensorSensitivity;
 	vector<double> sensorResolution;
 	vector<double> sensorSaturation;
+};
+
+class SensorManager: public CastaliaModule {
+ private:
+	/*--- The .ned file's parameters ---*/
+	bool printDebugInfo;
+	const SensorManagerParameters *params;
 
 	/*--- Custom class member variables ---*/
 	int self;		// the node's ID
@@ -48,6 +56,7 @@ class SensorManager: public CastaliaModule {
 	virtual void initialize();
 	virtual void handleMessage(cMessage * msg);
 	void parseStringParams(void);
+	void parseStringParams(SensorManagerParameters &);
 
  public:
 	double getSensorDeviceBias(int index);
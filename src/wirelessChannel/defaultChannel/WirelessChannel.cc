@@ -11,6 +11,8 @@
  ****************************************************************************/
 
 #include "WirelessChannel.h"
+#include "ResultWriter.h"
+#include "Radio.h"
 
 Define_Module(WirelessChannel);
 
@@ -128,7 +130,7 @@ void WirelessChannel::initialize(int stage)
 			else if (xIndex >= numOfXCells) {
 				xIndex = numOfXCells - 1;	// the maximum possible x index
 				if (nodeLocation[i].x > xFieldSize)
-					trace() << "WARNING at initialization: node position out of bounds in X dimension!\n";
+					TRACE << "WARNING at initialization: node position out of bounds in X dimension!\n";
 			}
 
 			int yIndex = (int)floor(nodeLocation[i].y / yFieldSize * numOfYCells);
@@ -137,7 +139,7 @@ void WirelessChannel::initialize(int stage)
 			else if (yIndex >= numOfYCells) {
 				yIndex = numOfYCells - 1;	// the maximum possible y index
 				if (nodeLocation[i].y > yFieldSize)
-					trace() << "WARNING at initialization: node position out of bounds in Y dimension!\n";
+					TRACE << "WARNING at initialization: node position out of bounds in Y dimension!\n";
 			}
 
 			int zIndex = (int)floor(nodeLocation[i].z / zFieldSize * numOfZCells);
@@ -146,7 +148,7 @@ void WirelessChannel::initialize(int stage)
 			else if (zIndex >= numOfZCells) {
 				zIndex = numOfZCells - 1;	// the maximum possible z index
 				if (nodeLocation[i].z > zFieldSize)
-					trace() << "WARNING at initialization: node position out of bounds in Z dimension!\n";
+					TRACE << "WARNING at initialization: node position out of bounds in Z dimension!\n";
 			}
 
 			int cell = zIndex * zIndexIncrement + yIndex * yIndexIncrement + xIndex * xIndexIncrement;
@@ -180,6 +182,16 @@ void WirelessChannel::initialize(int stage)
 	float PLd;		// path loss at distance dist, in dB
 	float bidirectionalPathLossJitter; // variation of the pathloss in the two directions of a link, in dB
 
+	/*******************************************************
+	 * With correlated shadowing, the random field is generated
+	 * once for the whole space and each link samples it at its
+	 * endpoints, instead of drawing an independent value
+	 *******************************************************/
+	shadowingModel = NULL;
+	if (correlatedShadowing)
+		shadowingModel = new channelShadowingModel(xFieldSize, yFieldSize,
+				shadowingDecorrelationDistance);
+
 	/*******************************************************
 	 * Calculate the distance, beyond which we cannot
 	 * have connectivity between two nodes. This calculation is
@@ -191,9 +203,39 @@ void WirelessChannel::initialize(int stage)
 	 * especially for the mobile case.
 	 *******************************************************/
 	float distanceThreshold = d0 *
-		pow(10.0,(maxTxPower - signalDeliveryThreshold - PLd0 + 3 * sigma) /
+		pow(10.0,(maxTxPower - min(signalDeliveryThreshold, interferenceThreshold) - PLd0 + 3 * sigma) /
 		(10.0 * pathLossExponent));
 
+	/*******************************************************
+	 * The weak interference tier keeps, for each cell, the
+	 * cells that receive a signal too weak to be delivered
+	 * but strong enough to add up as interference. Signals
+	 * on these links are accumulated in weakInterference_mW
+	 * instead of being sent as messages to each radio. The
+	 * radios that registered are told when the sum of their
+	 * cell changes, so RSSI and SINR follow it at all times.
+	 *******************************************************/
+	weakInterferenceDefined = interferenceThreshold < signalDeliveryThreshold;
+	weakPathLoss = NULL;
+	weakInterference_mW = NULL;
+	weakTxCell = NULL;
+	weakTxPower_dBm = NULL;
+	weakListener = NULL;
+	int totalWeakElements = 0;
+	if (weakInterferenceDefined) {
+		weakPathLoss = new list<PathLossElement*>[numOfSpaceCells];
+		weakInterference_mW = new double[numOfSpaceCells];
+		for (int i = 0; i < numOfSpaceCells; i++)
+			weakInterference_mW[i] = 0.0;
+		weakTxCell = new int[numOfNodes];
+		weakTxPower_dBm = new double[numOfNodes];
+		weakListener = new Radio*[numOfNodes];
+		for (int i = 0; i < numOfNodes; i++) {
+			weakTxCell[i] = -1;
+			weakListener[i] = NULL;
+		}
+	}
+
 	for (int i = 0; i < numOfSpaceCells; i++) {
 		if (onlyStaticNodes) {
 			x1 = nodeLocation[i].x;
@@ -239,27 +281,42 @@ void WirelessChannel::initialize(int stage)
 				bidirectionalPathLossJitter = 0;
 			}
 			else {
-				PLd = PLd0 + 10.0 * pathLossExponent * log10(dist / d0) + normal(0, sigma);
+				PLd = PLd0 + 10.0 * pathLossExponent * log10(dist / d0);
+				if (shadowingModel)
+					PLd += shadowingModel->linkShadowing(x1, y1, x2, y2, sigma);
+				else
+					PLd += normal(0, sigma);
 				bidirectionalPathLossJitter = normal(0, bidirectionalSigma) / 2;
 			}
 
 			if (maxTxPower - PLd - bidirectionalPathLossJitter >= signalDeliveryThreshold) {
 				pathLoss[i].push_front(new PathLossElement(j,PLd + bidirectionalPathLossJitter));
 				totalElements++;	//keep track of pathLoss size for reporting purposes
+			} else if (weakInterferenceDefined &&
+					maxTxPower - PLd - bidirectionalPathLossJitter >= interferenceThreshold) {
+				weakPathLoss[i].push_front(new PathLossElement(j,PLd + bidirectionalPathLossJitter));
+				totalWeakElements++;
 			}
 
 			if (maxTxPower - PLd + bidirectionalPathLossJitter >= signalDeliveryThreshold) {
 				pathLoss[j].push_front(new PathLossElement(i,PLd - bidirectionalPathLossJitter));
 				totalElements++;	//keep track of pathLoss size for reporting purposes
+			} else if (weakInterferenceDefined &&
+					maxTxPower - PLd + bidirectionalPathLossJitter >= interferenceThreshold) {
+				weakPathLoss[j].push_front(new PathLossElement(i,PLd - bidirectionalPathLossJitter));
+				totalWeakElements++;
 			}
 		}
 	}
 
-	trace() << "Number of distinct space cells: " << numOfSpaceCells;
-	trace() << "Each cell affects " <<
+	TRACE << "Number of distinct space cells: " << numOfSpaceCells;
+	TRACE << "Each cell affects " <<
 		(double)totalElements / numOfSpaceCells << " other cells on average";
-	trace() << "The pathLoss array of lists was allocated in " <<
+	TRACE << "The pathLoss array of lists was allocated in " <<
 	    (double)(totalElements * elementSize) / 1048576 << " MBytes";
+	if (weakInterferenceDefined)
+		TRACE << "Each cell adds weak interference to " <<
+			(double)totalWeakElements / numOfSpaceCells << " other cells on average";
 	// The larger this number, the slower your simulation. Consider increasing the cell size,
 	// decreasing the field size, or if you only have static nodes, decreasing the number of nodes
 
@@ -272,6 +329,16 @@ void WirelessChannel::initialize(int stage)
 	if (nodesAffectedByTransmitter == NULL)
 		opp_error("Could not allocate array nodesAffectedByTransmitter\n");
 
+	/* Radios register their carrier frequency when they start,
+	 * until then they receive signals of any frequency
+	 */
+	receiverCarrierFreq = new double[numOfNodes];
+	receiverFreqSpan = new double[numOfNodes];
+	for (int i = 0; i < numOfNodes; i++) {
+		receiverCarrierFreq[i] = 0.0;
+		receiverFreqSpan[i] = -1.0;
+	}
+
 	/************************************************************
 	 * If direct assignment of link qualities is given at the
 	 * omnetpp.ini file we parse the input and update pathLoss.
@@ -289,7 +356,7 @@ void WirelessChannel::initialize(int stage)
 
 	declareHistogram("Fade depth distribution", -50, 15, 13);
 
-	trace() << "Time for Wireless Channel module initialization: " <<
+	TRACE << "Time for Wireless Channel module initialization: " <<
 	    (double)(clock() - startTime) / CLOCKS_PER_SEC << "secs";
 }
 
@@ -374,6 +441,13 @@ void WirelessChannel::handleMessage(cMessage * msg)
 			/* Find the cell that the transmitting node resides */
 			int cellTx = nodeLocation[srcAddr].cell;
 
+			/* Add the contribution of this transmission to the weak interference tier */
+			if (weakInterferenceDefined) {
+				weakTxCell[srcAddr] = cellTx;
+				weakTxPower_dBm[srcAddr] = signalMsg->getPower_dBm();
+				updateWeakInterference(cellTx, signalMsg->getPower_dBm(), 1.0);
+			}
+
 			/* Iterate through the list of cells that are affected
 			 * by cellTx and check if there are nodes there.
 			 * Update the nodesAffectedByTransmitter array
@@ -417,6 +491,9 @@ void WirelessChannel::handleMessage(cMessage * msg)
 						it2 != cellOccupation[(*it1)->cellID].end(); it2++) {
 					if (*it2 == srcAddr)
 						continue;
+					/* Radios tuned too far from the carrier frequency get nothing */
+					if (!isTunedTo(*it2, signalMsg->getCarrierFreq()))
+						continue;
 					receptioncount++;
 					WirelessChannelSignalBegin *signalMsgCopy = signalMsg->dup();
 					signalMsgCopy->setPower_dBm(currentSignalReceived);
@@ -426,7 +503,7 @@ void WirelessChannel::handleMessage(cMessage * msg)
 			}	//for it1
 
 			if (receptioncount > 0)
-				trace() << "signal from node[" << srcAddr << "] reached " <<
+				TRACE << "signal from node[" << srcAddr << "] reached " <<
 						receptioncount << " other nodes";
 			break;
 		}
@@ -436,6 +513,12 @@ void WirelessChannel::handleMessage(cMessage * msg)
 			    check_and_cast <WirelessChannelSignalEnd*>(msg);
 			int srcAddr = signalMsg->getNodeID();
 
+			/* Remove the contribution of this transmission from the weak interference tier */
+			if (weakInterferenceDefined && weakTxCell[srcAddr] >= 0) {
+				updateWeakInterference(weakTxCell[srcAddr], weakTxPower_dBm[srcAddr], -1.0);
+				weakTxCell[srcAddr] = -1;
+			}
+
 			/* Go through the list of nodes that were affected
 			 *  by this transmission. *it1 holds the node ID
 			 */
@@ -479,9 +562,26 @@ void WirelessChannel::finishSpecific()
 	}
 	delete[]pathLoss;	// the delete[] operator releases memory allocated with new []
 
+	/* delete the weak interference tier */
+	if (weakInterferenceDefined) {
+		for (int i = 0; i < numOfSpaceCells; i++) {
+			list <PathLossElement*>::iterator it1;
+			for (it1 = weakPathLoss[i].begin(); it1 != weakPathLoss[i].end(); it1++)
+				delete(*it1);
+		}
+		delete[]weakPathLoss;
+		delete[]weakInterference_mW;
+		delete[]weakTxCell;
+		delete[]weakTxPower_dBm;
+		delete[]weakListener;
+	}
+
 	/* delete nodesAffectedByTransmitter */
 	delete[]nodesAffectedByTransmitter;	// the delete[] operator releases memory allocated with new []
 
+	delete[]receiverCarrierFreq;
+	delete[]receiverFreqSpan;
+
 	/* delete cellOccupation */
 	delete[]cellOccupation;	// the delete[] operator releases memory allocated with new []
 
@@ -491,6 +591,9 @@ void WirelessChannel::finishSpecific()
 	if (temporalModelDefined)
 		delete temporalModel;
 
+	if (shadowingModel)
+		delete shadowingModel;
+
 	//close the output stream that CASTALIA_DEBUG is writing to
 	DebugInfoWriter::closeStream();
 }
@@ -499,17 +602,33 @@ void WirelessChannel::readIniFileParameters(void)
 {
 	DebugInfoWriter::setDebugFileName(
 		getParentModule()->par("debugInfoFileName").stringValue());
+	DebugInfoWriter::setOutputOptions(
+		getParentModule()->par("debugInfoFormat").stringValue(),
+		getParentModule()->par("debugInfoBufferSize"),
+		getParentModule()->par("debugInfoFlushThread"));
+	ResultWriter::setResultFileName(
+		getParentModule()->par("resultFileName").stringValue());
 
 	onlyStaticNodes = par("onlyStaticNodes");
 	pathLossExponent = par("pathLossExponent");
 	sigma = par("sigma");
 	bidirectionalSigma = par("bidirectionalSigma");
+	shadowingDecorrelationDistance = par("shadowingDecorrelationDistance");
+
+	string shadowing = par("shadowingModel").stringValue();
+	if (shadowing == "independent")
+		correlatedShadowing = false;
+	else if (shadowing == "correlated")
+		correlatedShadowing = true;
+	else
+		opp_error("\n[Wireless Channel]:\n Unknown shadowingModel '%s'\n", shadowing.c_str());
 	PLd0 = par("PLd0");
 	d0 = par("d0");
 
 	pathLossMapFile = par("pathLossMapFile");
 	temporalModelParametersFile = par("temporalModelParametersFile");
 	signalDeliveryThreshold = par("signalDeliveryThreshold");
+	interferenceThreshold = par("interferenceThreshold");
 
 	numOfNodes = getParentModule()->par("numNodes");
 	xFieldSize = getParentModule()->par("field_x");
@@ -604,3 +723,65 @@ int WirelessChannel::parseFloat(const char *c, float *dst)
 		return 1;
 	return 0;
 }
+
+/* Add (sign = 1) or remove (sign = -1) the contribution of a transmission
+ * from a node in cell cellTx to the weak interference of all cells
+ * in the weakPathLoss list of cellTx. Only average path loss is used, the
+ * temporal model is not applied to this coarse tier.
+ */
+void WirelessChannel::updateWeakInterference(int cellTx, double txPower_dBm, double sign)
+{
+	list <PathLossElement*>::iterator it1;
+	for (it1 = weakPathLoss[cellTx].begin(); it1 != weakPathLoss[cellTx].end(); it1++) {
+		double *cellPower = &weakInterference_mW[(*it1)->cellID];
+		*cellPower += sign * pow(10.0, (txPower_dBm - (*it1)->avgPathLoss) / 10.0);
+		// clear residual rounding errors once all contributions are removed
+		if (*cellPower < 1e-15)
+			*cellPower = 0.0;
+
+		list <int>::iterator it2;
+		for (it2 = cellOccupation[(*it1)->cellID].begin();
+				it2 != cellOccupation[(*it1)->cellID].end(); it2++) {
+			if (weakListener[*it2])
+				weakListener[*it2]->weakInterferenceChanged();
+		}
+	}
+}
+
+/* Direct method call used by radios to read the aggregate power (in mW)
+ * received in their cell from transmissions below signalDeliveryThreshold
+ */
+double WirelessChannel::getWeakInterference_mW(int nodeID)
+{
+	Enter_Method_Silent();
+	if (!weakInterferenceDefined || nodeID < 0 || nodeID >= numOfNodes)
+		return 0.0;
+	return weakInterference_mW[nodeLocation[nodeID].cell];
+}
+
+/* Direct method call used by radios that add the weak interference to their
+ * noise floor, to be notified whenever it changes in their cell
+ */
+void WirelessChannel::setWeakInterferenceListener(int nodeID, Radio *radio)
+{
+	Enter_Method_Silent();
+	if (!weakInterferenceDefined)
+		return;
+	if (nodeID < 0 || nodeID >= numOfNodes)
+		opp_error("Wireless channel: weak interference listener set for unknown node %i", nodeID);
+	weakListener[nodeID] = radio;
+}
+
+/* Direct method call used by radios to register the carrier frequency they
+ * are tuned to, and the largest frequency offset (in MHz) of signals they
+ * can still sense through their adjacent channel rejection mask. Signals
+ * further away are not delivered to the radio at all.
+ */
+void WirelessChannel::setReceiverFrequency(int nodeID, double carrierFreq, double span)
+{
+	Enter_Method_Silent();
+	if (nodeID < 0 || nodeID >= numOfNodes)
+		opp_error("Wireless channel: receiver frequency set for unknown node %i", nodeID);
+	receiverCarrierFreq[nodeID] = carrierFreq;
+	receiverFreqSpan[nodeID] = span;
+}
@@ -15,6 +15,7 @@
 
 #include "WirelessChannelMessages_m.h"
 #include "WirelessChannelTemporal.h"
+#include "WirelessChannelShadowing.h"
 #include "VirtualMobilityManager.h"
 #include "CastaliaModule.h"
 
@@ -23,6 +24,8 @@
 
 using namespace std;
 
+class Radio;
+
 class PathLossElement {
  public:
 	int cellID;
@@ -61,10 +64,13 @@ class WirelessChannel: public CastaliaModule {
 	double d0;					// reference distance (in meters)
 	double sigma;				// std of a zero-mean Gaussian RV
 	double bidirectionalSigma;	// std of a zero-mean Gaussian RV
+	bool correlatedShadowing;	// draw shadowing from a spatially correlated field
+	double shadowingDecorrelationDistance;	// in meters
 
 	const char *pathLossMapFile;
 	const char *temporalModelParametersFile;
 	double signalDeliveryThreshold;
+	double interferenceThreshold;
 	bool onlyStaticNodes;
 	double receiverSensitivity;
 	double maxTxPower;			// this is derived, by reading all the Tx power levels
@@ -80,6 +86,30 @@ class WirelessChannel: public CastaliaModule {
 											// cells are affected (and how) when a
 											// node in cell i transmits.
 
+	bool weakInterferenceDefined;
+	list <PathLossElement*>*weakPathLoss;	// an array of lists (numOfSpaceCels long), like
+											// pathLoss but holding the cells that receive a
+											// signal between interferenceThreshold and
+											// signalDeliveryThreshold when a node in cell i
+											// transmits. These cells get no signal messages.
+
+	double *weakInterference_mW;			// an array (numOfSpaceCels long) with the total
+											// power currently received in each cell through
+											// the weakPathLoss lists, in mW
+
+	int *weakTxCell;						// arrays (numOfNodes long) that hold the cell and
+	double *weakTxPower_dBm;				// TX power of each transmitting node, so that its
+											// weak contribution can be removed at signal end
+
+	Radio **weakListener;					// an array (numOfNodes long) with the radio of each
+											// node that is notified when the weak interference
+											// of its cell changes, NULL if it did not register
+
+	double *receiverCarrierFreq;			// arrays (numOfNodes long) with the carrier frequency
+	double *receiverFreqSpan;				// each radio is tuned to and the largest offset (MHz)
+											// from it that the radio still hears. A negative span
+											// means the radio has not registered, it gets all signals
+
 	list <int>*nodesAffectedByTransmitter;	// an array of lists (numOfNodes long). The list
 											// at array element i holds the node IDs that are
 											// affected when node i transmits.
@@ -92,6 +122,7 @@ class WirelessChannel: public CastaliaModule {
 
 	bool temporalModelDefined;
 	channelTemporalModel *temporalModel;
+	channelShadowingModel *shadowingModel;	// NULL unless correlatedShadowing is used
 
  protected:
 	virtual void initialize(int);
@@ -105,8 +136,18 @@ class WirelessChannel: public CastaliaModule {
 	void printRxSignalTable(void);
 	void updatePathLossElement(int, int, float);
 	float calculateProb(float, int);
+	void updateWeakInterference(int, double, double);
+	bool isTunedTo(int nodeID, double carrierFreq) {
+		return receiverFreqSpan[nodeID] < 0 ||
+			fabs(carrierFreq - receiverCarrierFreq[nodeID]) <= receiverFreqSpan[nodeID];
+	}
 
 	int numInitStages() const;
+
+ public:
+	double getWeakInterference_mW(int);
+	void setWeakInterferenceListener(int, Radio *);
+	void setReceiverFrequency(int, double, double);
 };
 
 #endif				//_WIRELESSCHANNEL_H
@@ -0,0 +1,100 @@
+/****************************************************************************
+ *  Copyright: National ICT Australia,  2007 - 2010                         *
+ *  Developed at the ATP lab, Networked Systems research theme              *
+ *  Author(s): Athanassios Boulis, Yuriy Tselishchev                        *
+ *  This file is distributed under the terms in the attached LICENSE file.  *
+ *  If you do not find this file, copies can be found by writing to:        *
+ *                                                                          *
+ *      NICTA, Locked Bag 9013, Alexandria, NSW 1435, Australia             *
+ *      Attention:  License Inquiry.                                        *
+ *                                                                          *
+ ****************************************************************************/
+
+#include "WirelessChannelShadowing.h"
+
+//Constructor for channelShadowingModel, generates the field for an area of
+//xSize by ySize meters with the given decorrelation distance (in meters)
+channelShadowingModel::channelShadowingModel(double xSize, double ySize, double dCorr)
+{
+	if (dCorr <= 0)
+		opp_error("Shadowing decorrelation distance must be positive\n");
+	decorrelationDistance = dCorr;
+
+	/* Eight grid points per decorrelation distance are enough for the
+	 * interpolated field to keep the expected correlation at the scale of
+	 * dCorr, while the grid stays small even for large fields
+	 */
+	gridStep = dCorr / 8.0;
+	numOfXPoints = (int)ceil((xSize > 0 ? xSize : 0) / gridStep) + 2;
+	numOfYPoints = (int)ceil((ySize > 0 ? ySize : 0) / gridStep) + 2;
+	field = new float[numOfXPoints * numOfYPoints];
+
+	/* The 2D spectral density of the correlation exp(-d/dCorr) is
+	 * proportional to (1 + (k*dCorr)^2)^(-3/2). Radial wave numbers are
+	 * drawn by inverting its CDF, 1 - 1/sqrt(1 + (k*dCorr)^2), and the
+	 * directions and phases are uniform. The sum of NUM_OF_SINUSOIDS
+	 * cosines, scaled by sqrt(2/NUM_OF_SINUSOIDS), has unit variance.
+	 */
+	double kx[NUM_OF_SINUSOIDS], ky[NUM_OF_SINUSOIDS], phase[NUM_OF_SINUSOIDS];
+	for (int m = 0; m < NUM_OF_SINUSOIDS; m++) {
+		double u = uniform(0, 1);
+		double k = sqrt(1.0 / ((1.0 - u) * (1.0 - u)) - 1.0) / dCorr;
+		double angle = uniform(0, 2 * M_PI);
+		kx[m] = k * cos(angle);
+		ky[m] = k * sin(angle);
+		phase[m] = uniform(0, 2 * M_PI);
+	}
+
+	double scale = sqrt(2.0 / NUM_OF_SINUSOIDS);
+	for (int y = 0; y < numOfYPoints; y++) {
+		for (int x = 0; x < numOfXPoints; x++) {
+			double sum = 0;
+			for (int m = 0; m < NUM_OF_SINUSOIDS; m++) {
+				sum += cos(kx[m] * x * gridStep + ky[m] * y * gridStep + phase[m]);
+			}
+			field[y * numOfXPoints + x] = scale * sum;
+		}
+	}
+}
+
+channelShadowingModel::~channelShadowingModel()
+{
+	delete[]field;
+}
+
+//returns the value of the field at point (x,y) by bilinear interpolation
+//of the grid, points outside the grid are moved to its closest edge
+float channelShadowingModel::fieldValue(double x, double y)
+{
+	double gx = x / gridStep;
+	double gy = y / gridStep;
+	if (gx < 0) gx = 0;
+	if (gy < 0) gy = 0;
+	if (gx > numOfXPoints - 1) gx = numOfXPoints - 1;
+	if (gy > numOfYPoints - 1) gy = numOfYPoints - 1;
+
+	int x0 = (int)floor(gx);
+	int y0 = (int)floor(gy);
+	if (x0 > numOfXPoints - 2) x0 = numOfXPoints - 2;
+	if (y0 > numOfYPoints - 2) y0 = numOfYPoints - 2;
+	double fx = gx - x0;
+	double fy = gy - y0;
+
+	float *row0 = &field[y0 * numOfXPoints + x0];
+	float *row1 = row0 + numOfXPoints;
+	return (1 - fy) * ((1 - fx) * row0[0] + fx * row0[1]) +
+		fy * ((1 - fx) * row1[0] + fx * row1[1]);
+}
+
+/* Shadowing (in dB) of the link between points (x1,y1) and (x2,y2) for
+ * the given std. The link samples the field at both endpoints, so links
+ * with nearby endpoints are correlated. The sum of the two samples is
+ * normalised by its own std, sqrt(2(1 + rho)) where rho is the expected
+ * correlation at the link length, so that every link keeps variance sigma^2
+ */
+float channelShadowingModel::linkShadowing(double x1, double y1, double x2, double y2, double sigma)
+{
+	double dist = sqrt((x2 - x1) * (x2 - x1) + (y2 - y1) * (y2 - y1));
+	double rho = exp(-dist / decorrelationDistance);
+	return sigma * (fieldValue(x1, y1) + fieldValue(x2, y2)) / sqrt(2.0 * (1.0 + rho));
+}
@@ -0,0 +1,44 @@
+/****************************************************************************
+ *  Copyright: National ICT Australia,  2007 - 2010                         *
+ *  Developed at the ATP lab, Networked Systems research theme              *
+ *  Author(s): Athanassios Boulis, Yuriy Tselishchev                        *
+ *  This file is distributed under the terms in the attached LICENSE file.  *
+ *  If you do not find this file, copies can be found by writing to:        *
+ *                                                                          *
+ *      NICTA, Locked Bag 9013, Alexandria, NSW 1435, Australia             *
+ *      Attention:  License Inquiry.                                        *
+ *                                                                          *
+ ****************************************************************************/
+
+#ifndef __CHANNELSHADOWING_H
+#define __CHANNELSHADOWING_H
+
+#include <omnetpp.h>
+
+#define NUM_OF_SINUSOIDS 128
+
+/************************************************************************
+ * Spatially correlated shadowing (Gudmundson model). A zero mean, unit
+ * variance random field with correlation exp(-d/decorrelationDistance)
+ * is generated once on a regular 2D grid covering the field, as a sum
+ * of sinusoids whose wave vectors are drawn from the spectral density
+ * of the exponential correlation function. The cost of generation is
+ * proportional to the grid size and does not depend on the number of
+ * nodes. Each link then samples the field at its two endpoints by
+ * bilinear interpolation.
+ ************************************************************************/
+class channelShadowingModel {
+ private:
+	double decorrelationDistance;
+	double gridStep;
+	int numOfXPoints, numOfYPoints;
+	float *field;		// numOfXPoints x numOfYPoints grid, element [y * numOfXPoints + x]
+
+ public:
+	channelShadowingModel(double, double, double);
+	~channelShadowingModel();
+	float fieldValue(double, double);
+	float linkShadowing(double, double, double, double, double);
+};
+
+#endif
@@ -122,6 +122,8 @@ channelTemporalModel::channelTemporalModel(const char *file, int rng)
 				for (int i = 0; i < numOfCorrelationTimes; i++) {
 					correlationTime[i].time = parseFloat(v[i].c_str());
 					correlationTime[i].pdfs = new PDFType[numOfSignalVariationValues];
+					correlationTime[i].multiStepCDF = NULL;
+					correlationTime[i].maxSteps = 1;
 					if (i > 0 && correlationTime[i].time >= correlationTime[i - 1].time) {
 						std::cout << "[TemporalModel] ERROR: " << CORR_TIME <<
 						    " expected comma separated list of decreasing numbers" << std::endl;
@@ -154,6 +156,8 @@ channelTemporalModel::channelTemporalModel(const char *file, int rng)
 			}
 		}
 	}
+
+	calculateMultiStepTransitions();
 }
 
 channelTemporalModel::~channelTemporalModel()
@@ -176,6 +180,9 @@ channelTemporalModel::~channelTemporalModel()
 				delete[]correlationTime[i].pdfs[j].layers;
 			}
 			delete[]correlationTime[i].pdfs;
+			if (correlationTime[i].multiStepCDF) {
+				delete[]correlationTime[i].multiStepCDF;
+			}
 		}
 		delete[]correlationTime;
 	}
@@ -325,11 +332,158 @@ float channelTemporalModel::drawFromPDF(PDFType * pdf)
 	exit(1);
 }
 
+//Function to fill the array pointed by prob (numOfSignalVariationValues long) with the 
+//probabilities that a draw from the given PDF results in each of the discrete signal 
+//variation values. Layers are resolved in the same order and with the same recursion 
+//limit as drawFromPDF(...), the (negligible) mass remaining after the limit is dropped
+void channelTemporalModel::calculateIndexProbabilities(PDFType * pdf, double *prob)
+{
+	double *layerMass = new double[pdf->numOfLayers];
+	double *nextLayerMass = new double[pdf->numOfLayers];
+	for (int j = 0; j < numOfSignalVariationValues; j++) {
+		prob[j] = 0;
+	}
+	for (int l = 0; l < pdf->numOfLayers; l++) {
+		layerMass[l] = 0;
+	}
+	layerMass[0] = 1;
+
+	for (int guard = 0; guard < 100; guard++) {
+		int massLeft = 0;
+		for (int l = 0; l < pdf->numOfLayers; l++) {
+			nextLayerMass[l] = 0;
+		}
+		for (int l = 0; l < pdf->numOfLayers; l++) {
+			if (layerMass[l] == 0) {
+				continue;
+			}
+			PDFLayerType *layer = &pdf->layers[l];
+			double elementMass = layerMass[l] / layer->numOfTotalElements;
+			for (int k = 0; k < layer->numOfValues; k++) {
+				prob[calculateValueIndex(layer->values[k])] += elementMass;
+			}
+			for (int k = 0; k < layer->numOfSublayers; k++) {
+				nextLayerMass[layer->sublayers[k]] += elementMass;
+				massLeft = 1;
+			}
+		}
+		double *tmp = layerMass;
+		layerMass = nextLayerMass;
+		nextLayerMass = tmp;
+		if (!massLeft) {
+			break;
+		}
+	}
+	delete[]layerMass;
+	delete[]nextLayerMass;
+
+	double total = 0;
+	for (int j = 0; j < numOfSignalVariationValues; j++) {
+		total += prob[j];
+	}
+	if (total > 0) {
+		for (int j = 0; j < numOfSignalVariationValues; j++) {
+			prob[j] /= total;
+		}
+	}
+}
+
+/************************************************************************
+ * Each correlation time defines a Markov chain over the discrete signal
+ * variation values: the state after one period is the index of the
+ * value drawn from the PDF of the current state. When k > 1 periods of
+ * the same correlation time pass, only the state before the last draw
+ * matters, so we precompute the (k-1)-step transition matrices (powers
+ * of the one-step matrix) and store them as cumulative rows. A gap of k
+ * periods then needs one draw of the intermediate state plus one draw
+ * from the PDF of that state, instead of k draws. The number of periods
+ * per call is bounded by the previous (larger) correlation time, or by
+ * the coherence time for the first one, so the tables are small.
+ ************************************************************************/
+void channelTemporalModel::calculateMultiStepTransitions(void)
+{
+	int n = numOfSignalVariationValues;
+	double *oneStep = new double[n * n];
+	double *current = new double[n * n];
+	double *next = new double[n * n];
+
+	for (int i = 0; i < numOfCorrelationTimes; i++) {
+		double previousTime = (i == 0) ? coherenceTime : correlationTime[i - 1].time;
+		correlationTime[i].maxSteps = (int)ceil(previousTime / correlationTime[i].time);
+		if (correlationTime[i].maxSteps < 1) {
+			correlationTime[i].maxSteps = 1;
+		}
+		if (correlationTime[i].maxSteps == 1) {
+			continue;
+		}
+
+		for (int j = 0; j < n; j++) {
+			calculateIndexProbabilities(&correlationTime[i].pdfs[j], &oneStep[j * n]);
+		}
+		memcpy(current, oneStep, n * n * sizeof(double));
+
+		correlationTime[i].multiStepCDF = new double[(correlationTime[i].maxSteps - 1) * n * n];
+		for (int k = 1; k < correlationTime[i].maxSteps; k++) {
+			double *cdf = &correlationTime[i].multiStepCDF[(k - 1) * n * n];
+			for (int from = 0; from < n; from++) {
+				double sum = 0;
+				for (int to = 0; to < n; to++) {
+					sum += current[from * n + to];
+					cdf[from * n + to] = sum;
+				}
+				cdf[from * n + n - 1] = 1.0;
+			}
+			if (k + 1 == correlationTime[i].maxSteps) {
+				break;
+			}
+			//next = current * oneStep
+			for (int from = 0; from < n; from++) {
+				for (int to = 0; to < n; to++) {
+					next[from * n + to] = 0;
+				}
+				for (int mid = 0; mid < n; mid++) {
+					double p = current[from * n + mid];
+					if (p == 0) {
+						continue;
+					}
+					for (int to = 0; to < n; to++) {
+						next[from * n + to] += p * oneStep[mid * n + to];
+					}
+				}
+			}
+			double *tmp = current;
+			current = next;
+			next = tmp;
+		}
+	}
+	delete[]oneStep;
+	delete[]current;
+	delete[]next;
+}
+
+//Draws an index from a cumulative distribution (numOfSignalVariationValues long)
+int channelTemporalModel::drawFromCDF(double *cdf)
+{
+	double r = genk_dblrand(rngNum);
+	int low = 0;
+	int high = numOfSignalVariationValues - 1;
+	while (low < high) {
+		int mid = (low + high) / 2;
+		if (cdf[mid] > r) {
+			high = mid;
+		} else {
+			low = mid + 1;
+		}
+	}
+	return low;
+}
+
 //Another core function of the model. This function will update signal variation value pointed by value_ptr
 //based on the time that has passed since last observation. It will return the time value which has been
 //processed by the model (that is return value can never exceed input value of time)
 //Also if time is greater than coherence Time, the value from coherencePDF is drawn, and input time value is 
-//returned
+//returned. Several periods of the same correlation time are processed at once using the precomputed
+//multi-step transition tables (see calculateMultiStepTransitions)
 double channelTemporalModel::runTemporalModel(double time, float *value_ptr)
 {
 	if (time == 0 || time >= coherenceTime) {
@@ -338,11 +492,26 @@ double channelTemporalModel::runTemporalModel(double time, float *value_ptr)
 	}
 	double remaining_time = time;
 	for (int i = 0; i < numOfCorrelationTimes; i++) {
+		if (remaining_time < correlationTime[i].time) {
+			continue;
+		}
+		int steps = (int)floor(remaining_time / correlationTime[i].time);
+		remaining_time -= steps * correlationTime[i].time;
+		//guard against rounding, so that the result matches repeated subtraction
 		while (remaining_time >= correlationTime[i].time) {
 			remaining_time -= correlationTime[i].time;
-			*value_ptr = drawFromPDF(&correlationTime[i].pdfs[calculateValueIndex(*value_ptr)]);
+			steps++;
+		}
+		while (steps > 0) {
+			int k = steps < correlationTime[i].maxSteps ? steps : correlationTime[i].maxSteps;
+			int index = calculateValueIndex(*value_ptr);
+			if (k > 1) {
+				int n = numOfSignalVariationValues;
+				index = drawFromCDF(&correlationTime[i].multiStepCDF[((k - 2) * n + index) * n]);
+			}
+			*value_ptr = drawFromPDF(&correlationTime[i].pdfs[index]);
+			steps -= k;
 		}
 	}
 	return time - remaining_time;
 }
-
@@ -44,6 +44,10 @@ struct PDFType {
 struct correlationTimeType {
 	PDFType *pdfs;
 	double time;
+	int maxSteps;		//maximum number of consecutive periods of this correlation time
+						//that can be processed in a single call to runTemporalModel
+	double *multiStepCDF;	//cumulative k-step transition probabilities between signal
+							//variation values, indexed as [(k-1)][from][to] for k in [1..maxSteps-1]
 };
 
 class channelTemporalModel {
@@ -67,6 +71,9 @@ class channelTemporalModel {
 											//or too old (i.e. time passed > coherenceTime)
 
 	float drawFromPDF(PDFType *);
+	int drawFromCDF(double *);
+	void calculateIndexProbabilities(PDFType *, double *);
+	void calculateMultiStepTransitions(void);
 	float parseFloat(const char *);
 	void parsePDF(const char *, PDFType *);
 	void parseLayer(const char *, PDFLayerType *);
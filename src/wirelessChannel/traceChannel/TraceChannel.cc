@@ -11,6 +11,12 @@
  ****************************************************************************/
 
 #include "TraceChannel.h"
+#include "ResultWriter.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 
 Define_Module(TraceChannel);
 
@@ -18,6 +24,12 @@ void TraceChannel::initialize()
 {
 	DebugInfoWriter::setDebugFileName(
 		getParentModule()->par("debugInfoFileName").stringValue());
+	DebugInfoWriter::setOutputOptions(
+		getParentModule()->par("debugInfoFormat").stringValue(),
+		getParentModule()->par("debugInfoBufferSize"),
+		getParentModule()->par("debugInfoFlushThread"));
+	ResultWriter::setResultFileName(
+		getParentModule()->par("resultFileName").stringValue());
 
 	numNodes = getParentModule()->par("numNodes");
 	coordinator = par("coordinator");
@@ -32,15 +44,16 @@ void TraceChannel::initialize()
 	traceStep = (double)par("traceStep")/1000.0;
 		
 	nextLine = 0;
-	traceFile.open((const char *)par("traceFile"));
-	if (!traceFile.is_open())
-		opp_error("Could not open trace file for reading\n");
+	openTraceFile(par("traceFile"));
 	
 	signalDeliveryThreshold = par("signalDeliveryThreshold");
 	pathlossMapFile = par("pathlossMapFile");
 	temporalModelParametersFile = par("temporalModelParametersFile");
 	leafLinkProbability = par("leafLinkProbability");
 	temporalModel = NULL;
+
+	/* All elements are constructed with 0 pathloss, i.e. no reception */
+	pathlossMap = new PathLossElement[numNodes * numNodes];
 	
 	if (strlen(pathlossMapFile) != 0) {
 		parsePathLossMap(par("pathlossMapOffset"));
@@ -49,13 +62,12 @@ void TraceChannel::initialize()
 			temporalModel = new channelTemporalModel(temporalModelParametersFile, 2);
 		}
 	} else {
+		leafPathloss = par("leafPathloss");
 		for (int i = 0; i < numNodes; i++) {
 			for (int j = 0; j < numNodes; j++) {
 				// uniform(0,1) generates a random number in range [0,1)
 				if (leafLinkProbability > 0 && 	uniform(0,1) < leafLinkProbability) {
-					pathlossMap[i][j] = new PathLossElement((double)par("leafPathloss"));
-				} else {
-					pathlossMap[i][j] = new PathLossElement(0);
+					pathlossElement(i, j)->avgPathLoss = leafPathloss;
 				}
 			}
 		}
@@ -64,6 +76,81 @@ void TraceChannel::initialize()
 	declareOutput("Sensor-to-sensor links");
 }
 
+/* The trace file can be either in text format (one line per trace step with
+ * comma separated values) or in binary format created from a text trace by
+ * bin/CastaliaTraceConvert. The format is detected from the first bytes
+ */
+void TraceChannel::openTraceFile(const char *fileName)
+{
+	binaryTrace = false;
+	traceFd = -1;
+	traceMapping = NULL;
+	traceMappingSize = 0;
+	traceRows = NULL;
+	traceColumns = 0;
+	traceNumRows = 0;
+
+	traceFile.open(fileName, ios::in | ios::binary);
+	if (!traceFile.is_open())
+		opp_error("Could not open trace file for reading\n");
+
+	char magic[4];
+	traceFile.read(magic, 4);
+	if (traceFile.gcount() == 4 && memcmp(magic, TRACE_BINARY_MAGIC, 4) == 0) {
+		traceFile.close();
+		openBinaryTraceFile(fileName);
+		return;
+	}
+	traceFile.close();
+	traceFile.open(fileName);
+	if (!traceFile.is_open())
+		opp_error("Could not open trace file for reading\n");
+}
+
+void TraceChannel::openBinaryTraceFile(const char *fileName)
+{
+	traceFd = ::open(fileName, O_RDONLY);
+	if (traceFd < 0)
+		opp_error("Could not open binary trace file %s for reading\n", fileName);
+
+	struct stat st;
+	if (fstat(traceFd, &st) != 0 || (size_t)st.st_size < sizeof(TraceBinaryHeader))
+		opp_error("Binary trace file %s is too short\n", fileName);
+
+	traceMappingSize = st.st_size;
+	traceMapping = mmap(NULL, traceMappingSize, PROT_READ, MAP_SHARED, traceFd, 0);
+	if (traceMapping == MAP_FAILED) {
+		traceMapping = NULL;
+		opp_error("Could not memory map binary trace file %s\n", fileName);
+	}
+
+	const TraceBinaryHeader *header = (const TraceBinaryHeader *)traceMapping;
+	if (header->version != TRACE_BINARY_VERSION)
+		opp_error("Unsupported binary trace file version %u in %s\n", header->version, fileName);
+	traceColumns = header->numColumns;
+	traceNumRows = header->numRows;
+	if (sizeof(TraceBinaryHeader) + (size_t)traceColumns * traceNumRows * sizeof(float) > traceMappingSize)
+		opp_error("Binary trace file %s is truncated\n", fileName);
+
+	traceRows = (const float *)((const char *)traceMapping + sizeof(TraceBinaryHeader));
+	binaryTrace = true;
+	trace() << "Mapped binary trace with " << traceNumRows << " rows of " << traceColumns << " values";
+}
+
+void TraceChannel::closeTraceFile(void)
+{
+	if (binaryTrace) {
+		if (traceMapping)
+			munmap(traceMapping, traceMappingSize);
+		if (traceFd >= 0)
+			::close(traceFd);
+		traceMapping = NULL;
+		traceFd = -1;
+	} else {
+		traceFile.close();
+	}
+}
+
 void TraceChannel::parsePathLossMap(double offset)
 {
 
@@ -101,7 +188,9 @@ void TraceChannel::parsePathLossMap(double offset)
 				ct++;	//skip untill ':' character
 			if (parseFloat(++ct, &pathloss_db))
 				opp_error("\n[Wireless Channel]:\n Bad syntax in pathLossMapFile, expecting dB value for path loss\n");
-			pathlossMap[source][destination] = new PathLossElement(pathloss_db + offset);
+			if (source >= numNodes || destination >= numNodes)
+				opp_error("\n[Wireless Channel]:\n Node identifier out of range in pathLossMapFile\n");
+			pathlossElement(source, destination)->avgPathLoss = pathloss_db + offset;
 		}
 	}
 	f.close();
@@ -134,17 +223,18 @@ void TraceChannel::handleMessage(cMessage * msg)
 			} else if (i == coordinator) {	
 				//transmission to coordinator
 				signalPower -= currentPathloss(srcAddr);
-			} else if (pathlossMap[i][srcAddr]->avgPathLoss != 0) { 		
+			} else if (pathlossElement(i, srcAddr)->avgPathLoss != 0) { 		
 				//transmission between two leaf nodes
-				signalPower -= pathlossMap[i][srcAddr]->avgPathLoss;
+				PathLossElement *link = pathlossElement(i, srcAddr);
+				signalPower -= link->avgPathLoss;
 				if (temporalModel) {
-					simtime_t timePassed_msec = (simTime() - pathlossMap[i][srcAddr]->lastObservationTime) * 1000;
+					simtime_t timePassed_msec = (simTime() - link->lastObservationTime) * 1000;
 					simtime_t timeProcessed_msec =
 							temporalModel->runTemporalModel(SIMTIME_DBL(timePassed_msec),
-							&pathlossMap[i][srcAddr]->lastObservedDiff);
-					signalPower += pathlossMap[i][srcAddr]->lastObservedDiff;
+							&link->lastObservedDiff);
+					signalPower += link->lastObservedDiff;
 					/* Update the observation time */
-					pathlossMap[i][srcAddr]->lastObservationTime = simTime() -
+					link->lastObservationTime = simTime() -
 							(timePassed_msec - timeProcessed_msec) / 1000;
 				}
 			} else {						
@@ -204,12 +294,40 @@ void TraceChannel::handleMessage(cMessage * msg)
 
 void TraceChannel::finishSpecific()
 {
-	traceFile.close();
+	closeTraceFile();
+
+	delete[]pathlossMap;
+	delete[]nodesAffectedByTransmitter;
+	if (temporalModel)
+		delete temporalModel;
+
 	//close the output stream that CASTALIA_DEBUG is writing to
 	DebugInfoWriter::closeStream();
 }
 
+/* In binary mode, the row for the current time is found directly, there
+ * is no need to read and parse all the skipped trace steps
+ */
+const float *TraceChannel::currentTraceRow(void)
+{
+	long row = (long)floor(SIMTIME_DBL(simTime()) / traceStep);
+	if (row >= traceNumRows)
+		opp_error("trace file ended at row %li, trace for time %s is not available",
+				traceNumRows, SIMTIME_STR(simTime()));
+	return traceRows + row * traceColumns;
+}
+
 float TraceChannel::currentPathloss(int nodeId) {
+	if (binaryTrace) {
+		if (nodeId > coordinator) nodeId--;
+		if (nodeId >= traceColumns) {
+			opp_error("trace file does not provide information for node %i (%i columns)",
+					nodeId, traceColumns);
+		}
+		float value = currentTraceRow()[nodeId];
+		return value > 0 ? value : -value;
+	}
+
 	simtime_t time = simTime();
 	if (time >= nextLine) {
 		std::string s;
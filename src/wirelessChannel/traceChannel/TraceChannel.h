@@ -23,15 +23,28 @@
 #include <cstring>
 #include <map>
 
+#define TRACE_BINARY_MAGIC "CTRB"
+#define TRACE_BINARY_VERSION 1
+
 using namespace std;
 
+/* Header of a binary trace file, as written by bin/CastaliaTraceConvert.
+ * The header is followed by numRows rows of numColumns floats each
+ */
+struct TraceBinaryHeader {
+	char magic[4];
+	unsigned int version;
+	unsigned int numColumns;
+	unsigned int numRows;
+};
+
 class PathLossElement {
  public:
 	float avgPathLoss;
 	float lastObservedDiff;
 	simtime_t lastObservationTime;
 
-	PathLossElement(float PL) {
+	PathLossElement(float PL = 0) {
 		avgPathLoss = PL;
 		lastObservedDiff = 0.0;
 		lastObservationTime = 0.0;
@@ -55,12 +68,22 @@ class TraceChannel: public CastaliaModule {
 	const char *pathlossMapFile;
 	const char *temporalModelParametersFile;
 	channelTemporalModel *temporalModel;
-	map < int,map<int,PathLossElement*> > pathlossMap;
+	PathLossElement *pathlossMap;	// a numNodes x numNodes array, element [i * numNodes + j]
+									// holds pathloss between nodes i and j, 0 means no reception
 
 	/*--- state variables for trace file processing ---*/
 	ifstream traceFile;
  	simtime_t nextLine;
  	vector <float>traceValues; 	
+
+	/*--- state variables for binary trace file processing ---*/
+	bool binaryTrace;
+	int traceFd;
+	void *traceMapping;				// memory mapped binary trace file
+	size_t traceMappingSize;
+	const float *traceRows;			// first row of values in the mapped file
+	int traceColumns;
+	long traceNumRows;
 	
 	list <int>*nodesAffectedByTransmitter;	// an array of lists (numOfNodes long). The list
 											// at array element i holds the node IDs that are
@@ -69,7 +92,12 @@ class TraceChannel: public CastaliaModule {
 	virtual void initialize();
 	virtual void handleMessage(cMessage * msg);
 	virtual void finishSpecific();
+	PathLossElement *pathlossElement(int i, int j) { return &pathlossMap[i * numNodes + j]; }
 	float currentPathloss(int);
+	const float *currentTraceRow(void);
+	void openTraceFile(const char *);
+	void openBinaryTraceFile(const char *);
+	void closeTraceFile(void);
 	float parseFloat(const char *);
 	int parseFloat(const char *, float *);
 	int parseInt(const char *, int *);